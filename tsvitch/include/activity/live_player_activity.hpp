@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 
 #include <borealis/core/activity.hpp>
 #include <borealis/core/bind.hpp>
@@ -8,6 +9,7 @@
 
 #include "utils/event_helper.hpp"
 #include "presenter/live_data.hpp"
+#include "tsvitch/util/channel_view.hpp"
 
 class VideoView;
 
@@ -18,6 +20,9 @@ public:
     explicit LiveActivity(const std::vector<tsvitch::LiveM3u8>& channels, size_t startIndex,
                           std::function<void()> onClose = nullptr);
 
+    /// Canali della vista, condivisi con la lista da cui è stato aperto il player
+    LiveActivity(tsvitch::ChannelView channels, size_t startIndex, std::function<void()> onClose = nullptr);
+
     void setCommonData();
 
     void onContentAvailable() override;
@@ -48,7 +53,7 @@ protected:
 
     std::function<void()> onCloseCallback;
 
-    std::vector<tsvitch::LiveM3u8> channelList;
+    tsvitch::ChannelView channels;
     size_t currentChannelIndex = 0;
 
     size_t toggleDelayIter = 0;
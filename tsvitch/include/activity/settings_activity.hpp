@@ -43,6 +43,8 @@ private:
     
     // IPTV Configuration
     BRLS_BIND(TsVitchSelectorCell, selectorIPTVMode, "setting/iptv/mode_selector");
+    BRLS_BIND(TsVitchSelectorCell, selectorCacheMaxAge, "setting/iptv/cache_max_age");
+    BRLS_BIND(TsVitchSelectorCell, selectorChannelOrder, "setting/iptv/channel_order");
     BRLS_BIND(brls::Box, boxM3U8Section, "setting/iptv/m3u8_section");
     BRLS_BIND(brls::Box, boxXtreamSection, "setting/iptv/xtream_section");
     
@@ -50,6 +52,7 @@ private:
     BRLS_BIND(brls::InputCell, btnM3U8Input, "setting/tools/m3u8/input");
     BRLS_BIND(brls::InputCell, btnProxyInput, "setting/tools/proxy/input");
     BRLS_BIND(TsVitchSelectorCell, selectorM3U8Timeout, "setting/tools/m3u8/timeout");
+    BRLS_BIND(TsVitchSelectorCell, selectorM3U8Threads, "setting/tools/m3u8/threads");
     
     // Xtream Controls
     BRLS_BIND(brls::InputCell, btnXtreamServer, "setting/iptv/xtream_server");
@@ -62,6 +65,7 @@ private:
     BRLS_BIND(TsVitchSelectorCell, selectorUIScale, "setting/ui/scale");
     BRLS_BIND(TsVitchSelectorCell, selectorTexture, "setting/image/texture");
     BRLS_BIND(TsVitchSelectorCell, selectorThreads, "setting/image/threads");
+    BRLS_BIND(TsVitchSelectorCell, selectorImageDiskCache, "setting/image/disk_cache");
     BRLS_BIND(TsVitchSelectorCell, selectorKeymap, "setting/keymap");
     BRLS_BIND(brls::BooleanCell, btnKeymapSwap, "setting/keymap_swap");
     BRLS_BIND(brls::BooleanCell, btnOpencc, "setting/opencc");
@@ -9,6 +9,7 @@ namespace tsvitch {
 
 class LiveM3u8;
 typedef std::vector<LiveM3u8> LiveM3u8ListResult;
+class ChannelGroups;
 
 using ErrorCallback = std::function<void(const std::string&, int code)>;
 
@@ -17,18 +18,28 @@ using ErrorCallback = std::function<void(const std::string&, int code)>;
 
 class TsVitchClient {
 public:
-    static void get_file_m3u8(const std::function<void(LiveM3u8ListResult)>& callback = nullptr,
-                              const ErrorCallback& error                              = nullptr);
-
-    static void get_xtream_channels(const std::function<void(LiveM3u8ListResult)>& callback = nullptr,
-                                   const ErrorCallback& error                               = nullptr);
-
-    static void get_xtream_channels_with_retry(const std::function<void(LiveM3u8ListResult)>& callback = nullptr,
-                                              const ErrorCallback& error                               = nullptr,
-                                              int maxRetries                                           = 3);
-
-    static void get_live_channels(const std::function<void(LiveM3u8ListResult)>& callback = nullptr,
-                                 const ErrorCallback& error                               = nullptr);
+    /// I canali arrivano già raggruppati, con l'indice costruito sul thread che li ha letti.
+    /// preview riceve una volta i primi canali analizzati mentre il download è ancora in corso
+    static void get_file_m3u8(const std::function<void(ChannelGroups)>& callback = nullptr,
+                              const ErrorCallback& error                         = nullptr,
+                              const std::function<void(ChannelGroups)>& preview  = nullptr,
+                              const std::function<void()>& notModified           = nullptr);
+
+    static void get_xtream_channels(const std::function<void(ChannelGroups)>& callback = nullptr,
+                                   const ErrorCallback& error                         = nullptr,
+                                   const std::function<void()>& notModified           = nullptr);
+
+    static void get_xtream_channels_with_retry(const std::function<void(ChannelGroups)>& callback = nullptr,
+                                              const ErrorCallback& error                         = nullptr,
+                                              int maxRetries                                     = 3,
+                                              const std::function<void()>& notModified           = nullptr);
+
+    /// Se notModified è valorizzato la richiesta è condizionale (ETag / Last-Modified della cache):
+    /// quando la sorgente non è cambiata viene chiamato notModified al posto di callback
+    static void get_live_channels(const std::function<void(ChannelGroups)>& callback = nullptr,
+                                 const ErrorCallback& error                         = nullptr,
+                                 const std::function<void(ChannelGroups)>& preview  = nullptr,
+                                 const std::function<void()>& notModified           = nullptr);
 
     static void register_user(
                               const std::function<void(const std::string&, int)>& callback = nullptr,
@@ -113,8 +113,23 @@ public:
     std::string logo;
     std::string groupTitle;
     std::string url;
+    std::string tvgName;
+    std::string tvgRec;
+    std::string catchup;
+    std::string catchupSource;
 };
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(LiveM3u8, id, chno, title, logo, groupTitle, url)
+inline void to_json(nlohmann::json& nlohmann_json_j, const LiveM3u8& nlohmann_json_t) {
+    NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(NLOHMANN_JSON_TO, id, chno, title, logo, groupTitle, url, tvgName, tvgRec,
+                                             catchup, catchupSource));
+}
+inline void from_json(const nlohmann::json& nlohmann_json_j, LiveM3u8& nlohmann_json_t) {
+    NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(NLOHMANN_JSON_FROM, id, chno, title, logo, groupTitle, url));
+    // Campi aggiunti in seguito: assenti nella cronologia e nei preferiti salvati in precedenza
+    nlohmann_json_t.tvgName       = nlohmann_json_j.value("tvgName", "");
+    nlohmann_json_t.tvgRec        = nlohmann_json_j.value("tvgRec", "");
+    nlohmann_json_t.catchup       = nlohmann_json_j.value("catchup", "");
+    nlohmann_json_t.catchupSource = nlohmann_json_j.value("catchupSource", "");
+}
 
 typedef std::vector<LiveM3u8> LiveM3u8ListResult;
 
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "tsvitch/util/channel_store.hpp"
+
+namespace tsvitch {
+
+/**
+ * Differenze tra due versioni della lista canali.
+ *
+ * I canali sono identificati da tvg-id e URL: a parità di chiave un canale
+ * con titolo, logo, gruppo o altri attributi diversi risulta modificato.
+ * Le chiavi ripetute vengono abbinate nell'ordine in cui compaiono.
+ * Il costo è lineare nel numero di canali, con un accesso a tabella hash per canale.
+ */
+struct ChannelDiff {
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    /// Per ogni canale della nuova lista, l'indice dello stesso canale nella vecchia (NONE se è nuovo)
+    std::vector<uint32_t> source;
+    /// Indici nella nuova lista, in ordine crescente
+    std::vector<size_t> added;
+    std::vector<size_t> changed;
+    /// Indici nella vecchia lista, in ordine crescente
+    std::vector<size_t> removed;
+    /// Valori di group-title (anche vuoti) i cui canali non sono più gli stessi o sono stati riordinati
+    std::unordered_set<std::string> touchedGroups;
+
+    size_t size() const { return added.size() + changed.size() + removed.size(); }
+
+    /// Nessun canale aggiunto, rimosso, modificato o spostato
+    bool empty() const { return size() == 0 && touchedGroups.empty(); }
+
+    static ChannelDiff compute(const ChannelStore& oldList, const ChannelStore& newList);
+
+    /// Canale i di a e canale j di b identici in tutti i campi
+    static bool sameChannel(const ChannelStore& a, size_t i, const ChannelStore& b, size_t j);
+};
+
+}  // namespace tsvitch
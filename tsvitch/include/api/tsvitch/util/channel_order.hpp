@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "tsvitch/util/channel_store.hpp"
+
+namespace tsvitch {
+
+struct ChannelDiff;
+
+/// Ordinamento dei canali all'interno di un gruppo
+enum class ChannelOrder : uint8_t { PLAYLIST, NAME, NUMBER, MOST_WATCHED, RECENTLY_ADDED };
+constexpr size_t CHANNEL_ORDER_COUNT = 5;
+
+/// Visualizzazioni per canale, indicizzate con watchKey dell'URL
+using WatchCounts = std::unordered_map<uint64_t, uint32_t>;
+
+/// Chiave dell'URL di un canale, anche diviso in prefisso e resto come nello store
+uint64_t watchKey(std::string_view prefix, std::string_view tail = {});
+
+/**
+ * Chiavi degli ordinamenti di una lista canali.
+ *
+ * Per nome e per numero sono permutazioni dello store, un uint32_t per canale,
+ * ordinate confrontando le sequenze di cifre come numeri ("Rai 2" prima di
+ * "Rai 10"). addedAt è il momento in cui ogni canale è comparso nella lista,
+ * riportato da una versione all'altra con ChannelDiff.
+ *
+ * Si calcolano in background una volta per lista e vengono salvate accanto alla
+ * cache (ChannelManager::saveOrders): all'avvio non si riordina nulla.
+ */
+struct ChannelOrders {
+    /// Permutazioni dello store: per titolo, e per numero del canale (chno) con quelli
+    /// senza numero in fondo. A parità di titolo l'ordine della playlist, di numero il titolo
+    std::vector<uint32_t> byName;
+    std::vector<uint32_t> byNumber;
+    /// Per canale, secondi dall'epoch della prima lista in cui è comparso
+    std::vector<uint32_t> addedAt;
+    /// fingerprint dello store da cui sono state calcolate
+    uint64_t source = 0;
+
+    /// Ordinamenti di store. I canali già presenti in previous, abbinati con diff,
+    /// conservano la data in cui sono comparsi; gli altri risultano aggiunti a now
+    static ChannelOrders compute(const ChannelStore& store, uint32_t now, const ChannelOrders* previous = nullptr,
+                                 const ChannelDiff* diff = nullptr);
+
+    /// Impronta di titoli, numeri e URL dei canali, per riconoscere ordinamenti di un'altra lista
+    static uint64_t fingerprint(const ChannelStore& store);
+
+    /// Ordinamenti calcolati per store
+    bool matches(const ChannelStore& store) const;
+};
+
+}  // namespace tsvitch
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tsvitch/util/channel_store.hpp"
+
+namespace tsvitch {
+
+/**
+ * Indice per la ricerca dei canali per titolo e gruppo.
+ *
+ * Titoli e nomi dei gruppi vengono convertiti una volta sola in chiave di ricerca
+ * (foldText) e salvati in un'unica arena. Per ogni trigramma, cioè tre byte
+ * consecutivi di una chiave, c'è la lista ordinata dei canali che lo contengono.
+ * Tutte le liste sono intervalli di un unico array.
+ *
+ * Una ricerca interseca le liste dei trigrammi del testo cercato, partendo dalla
+ * più corta, e confronta con il testo solo i canali rimasti. I trigrammi sono
+ * distribuiti con un hash su TRIGRAM_BUCKETS liste: una collisione aggiunge
+ * candidati da verificare, mai risultati sbagliati.
+ *
+ * find() divide il testo in parole e assegna a ogni canale un punteggio: ogni parola
+ * deve comparire nel titolo, nel gruppo o come numero del canale. Le parole di
+ * almeno quattro byte ammettono errori di battitura (uno, o due da otto byte in su),
+ * confrontate con un bitap (Wu-Manber) sulle chiavi già convertite. Il titolo esatto
+ * vale sempre più di uno con errori: se le corrispondenze esatte bastano a riempire
+ * i risultati, la ricerca con errori viene saltata.
+ *
+ * Si costruisce in background dopo il caricamento della lista, poi è immutabile
+ * e può essere condiviso tra thread.
+ */
+class ChannelSearchIndex {
+public:
+    ChannelSearchIndex() = default;
+    explicit ChannelSearchIndex(std::shared_ptr<const ChannelStore> store);
+
+    /// Interrompe una ricerca non più necessaria: viene controllata a intervalli regolari
+    using Cancelled = std::function<bool()>;
+
+    /// Al massimo limit canali che corrispondono a tutte le parole di text, senza distinzione
+    /// tra maiuscole e minuscole, dal punteggio più alto: numero del canale, titolo che inizia
+    /// con la parola, parola del titolo che inizia con essa, titolo e poi gruppo che la
+    /// contengono, infine le stesse con errori. A parità prima i titoli più corti, poi
+    /// l'ordine dello store. Vuoto se la ricerca viene interrotta
+    std::vector<uint32_t> find(std::string_view text, size_t limit, const Cancelled& cancelled = nullptr) const;
+
+    /// Come find ma senza indice, confrontando tutti i canali, nell'ordine dello store
+    static std::vector<uint32_t> scan(const ChannelStore& store, std::string_view text,
+                                      const Cancelled& cancelled = nullptr);
+
+    const std::shared_ptr<const ChannelStore>& store() const { return channels; }
+
+    /// Byte occupati da chiavi e liste (stima, per il log)
+    size_t memoryUsage() const;
+
+private:
+    static constexpr uint32_t TRIGRAM_BITS    = 18;
+    static constexpr uint32_t TRIGRAM_BUCKETS = 1u << TRIGRAM_BITS;
+
+    static uint32_t bucket(const char* trigram);
+
+    struct QueryWord;
+
+    std::string_view titleKey(size_t index) const {
+        return std::string_view(keys.data() + keyOffsets[index], keyOffsets[index + 1] - keyOffsets[index] - 1);
+    }
+
+    // Canali con un titolo che contiene key, in ordine crescente
+    std::vector<uint32_t> findTitles(std::string_view key, const Cancelled& cancelled) const;
+
+    // Canali che contengono word senza errori (titolo, gruppo o numero), in ordine crescente
+    std::vector<uint32_t> findExact(const QueryWord& word, const Cancelled& cancelled) const;
+
+    // Punteggio del canale per word con al più maxErrors errori, 0 se non corrisponde
+    uint32_t wordScore(const QueryWord& word, size_t index, uint32_t maxErrors) const;
+
+    std::shared_ptr<const ChannelStore> channels;
+
+    // Chiavi dei titoli separate da '\n', che non compare mai in una chiave;
+    // keyOffsets ha un elemento in più per l'ultima
+    std::string keys;
+    std::vector<uint32_t> keyOffsets;
+
+    // Chiavi dei gruppi per id, e canali di ogni gruppo (intervalli di groupChannels)
+    std::vector<std::string> groupKeys;
+    std::vector<uint32_t> groupOffsets;
+    std::vector<uint32_t> groupChannels;
+
+    // Numero del canale (chno) per canale, NO_NUMBER se manca o non è un numero
+    static constexpr uint32_t NO_NUMBER = UINT32_MAX;
+    std::vector<uint32_t> numbers;
+
+    // Per canale, un bit per ogni byte (lettera, cifra o gruppo di simboli) presente nella
+    // chiave del titolo: scarta senza bitap i titoli a cui mancano troppi byte di una parola
+    std::vector<uint64_t> signatures;
+
+    // Lista di ogni trigramma: postings[postingOffsets[b], postingOffsets[b + 1])
+    std::vector<uint32_t> postingOffsets;
+    std::vector<uint32_t> postings;
+};
+
+}  // namespace tsvitch
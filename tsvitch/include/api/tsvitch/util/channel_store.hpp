@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tsvitch/result/home_live_result.h"
+
+namespace tsvitch {
+
+class MappedFile;
+
+/**
+ * Lista canali in formato colonnare.
+ *
+ * Ogni campo testuale è un intervallo (offset e lunghezza a 32 bit) in un'unica
+ * arena di caratteri. group-title e la parte iniziale di URL e logo (fino
+ * all'ultima '/') sono salvati una sola volta in tabelle condivise. Per canale
+ * restano così poche decine di byte più il testo non ripetuto, invece di dieci
+ * std::string allocate separatamente.
+ *
+ * I campi si leggono come std::string_view. URL e logo, divisi in prefisso e
+ * resto, vengono ricomposti in una std::string. at() ricostruisce un LiveM3u8
+ * completo solo dove serve (player, cronologia, preferiti).
+ *
+ * Le colonne e l'arena hanno la stessa forma in memoria e su disco: serialize()
+ * le scrive così come sono e deserialize() le usa direttamente da un file
+ * mappato, senza copie. Uno store mappato viene copiato in memoria solo se si
+ * aggiungono canali.
+ *
+ * Una volta costruita viene condivisa in sola lettura tra UI e thread in background.
+ */
+class ChannelStore {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    ChannelStore() = default;
+
+    static ChannelStore fromList(const LiveM3u8ListResult& list);
+
+    size_t size() const { return groupIds.size(); }
+    bool empty() const { return groupIds.size() == 0; }
+
+    void reserve(size_t channels);
+
+    void push_back(const LiveM3u8& channel);
+
+    /// Copia il canale index di other
+    void push_back(const ChannelStore& other, size_t index);
+
+    /// Accoda tutti i canali di other
+    void append(const ChannelStore& other);
+
+    /// Rende contigui i canali con lo stesso group-title, con i gruppi nell'ordine in cui
+    /// compaiono e l'ordine originale all'interno di ogni gruppo. Non fa nulla se lo sono già
+    void sortByGroup();
+
+    /// Canale completo, con copie dei campi
+    LiveM3u8 at(size_t index) const;
+
+    std::string_view id(size_t index) const { return view(ids[index]); }
+    std::string_view chno(size_t index) const { return view(chnos[index]); }
+    std::string_view title(size_t index) const { return view(titles[index]); }
+    std::string_view tvgName(size_t index) const { return view(tvgNames[index]); }
+    std::string_view tvgRec(size_t index) const { return view(tvgRecs[index]); }
+    std::string_view catchup(size_t index) const { return view(catchups[index]); }
+    std::string_view catchupSource(size_t index) const { return view(catchupSources[index]); }
+
+    /// group-title del canale, anche vuoto
+    const std::string& group(size_t index) const { return groups.values[groupIds[index]]; }
+    uint32_t groupId(size_t index) const { return groupIds[index]; }
+    const std::vector<std::string>& groupTable() const { return groups.values; }
+
+    std::string_view urlPrefix(size_t index) const { return prefixes.values[urlPrefixes[index]]; }
+    std::string_view urlTail(size_t index) const { return view(urlTails[index]); }
+    std::string url(size_t index) const { return join(urlPrefix(index), urlTail(index)); }
+    bool urlEquals(size_t index, std::string_view value) const;
+
+    std::string_view logoPrefix(size_t index) const { return prefixes.values[logoPrefixes[index]]; }
+    std::string_view logoTail(size_t index) const { return view(logoTails[index]); }
+    std::string logo(size_t index) const { return join(logoPrefix(index), logoTail(index)); }
+
+    /// Byte occupati in memoria da colonne, arena e tabelle (stima, per il log); esclude il file mappato
+    size_t memoryUsage() const;
+
+    /// Colonne e arena puntano a un file mappato
+    bool isMapped() const { return file != nullptr; }
+
+    using Sink = std::function<void(const void* data, size_t size)>;
+
+    /// Scrive l'immagine binaria dello store in blocchi contigui, già allineati a 8 byte
+    void serialize(const Sink& sink) const;
+
+    /// Store in sola lettura sull'immagine scritta da serialize, a partire da offset
+    /// (multiplo di 8) e lunga size byte. Gli intervalli vengono controllati: un file
+    /// incoerente restituisce false senza mai leggere fuori dall'immagine
+    static bool deserialize(std::shared_ptr<const MappedFile> file, size_t offset, size_t size, ChannelStore& out);
+
+    /// Legge size byte dall'offset indicato dell'immagine
+    using Reader = std::function<bool(uint64_t offset, void* data, size_t size)>;
+
+    /// Accoda a out i canali [first, first + count) di un'immagine scritta da serialize,
+    /// leggendo solo le parti delle colonne e dell'arena che li riguardano
+    static bool readRange(const Reader& read, size_t first, size_t count, ChannelStore& out);
+
+private:
+    struct Span {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // Intestazione dell'immagine binaria, seguita da tabelle, colonne e arena
+    struct ImageHeader {
+        uint32_t channels;
+        uint32_t groups;
+        uint32_t prefixes;
+        uint32_t reserved;
+        uint64_t tableBytes;
+        uint64_t arenaBytes;
+    };
+
+    // Posizione delle sezioni dell'immagine, ricavata dall'intestazione
+    struct ImageLayout {
+        uint64_t tables, tableText, spanColumns, idColumns, arena;
+
+        explicit ImageLayout(const ImageHeader& header);
+        uint64_t spanColumn(size_t column) const { return spanColumns + column * spanColumnBytes; }
+        uint64_t idColumn(size_t column) const { return idColumns + column * idColumnBytes; }
+
+    private:
+        uint64_t spanColumnBytes, idColumnBytes;
+    };
+
+    // Valori contigui, in un vettore proprio oppure nel file mappato
+    template <typename T>
+    class Column {
+    public:
+        const T* data() const { return external ? external : owned.data(); }
+        const T& operator[](size_t index) const { return data()[index]; }
+        size_t size() const { return external ? count : owned.size(); }
+        size_t capacity() const { return owned.capacity(); }
+
+        void reserve(size_t n) { owned.reserve(n); }
+        void push_back(const T& value) { owned.push_back(value); }
+        void append(const T* values, size_t n) { owned.insert(owned.end(), values, values + n); }
+
+        void map(const T* values, size_t n) {
+            owned   = {};
+            external = values;
+            count    = n;
+        }
+
+        /// Copia in memoria i valori mappati, prima di modificarli
+        void detach() {
+            if (!external) return;
+            owned.assign(external, external + count);
+            external = nullptr;
+            count    = 0;
+        }
+
+    private:
+        std::vector<T> owned;
+        const T* external = nullptr;
+        size_t count      = 0;
+    };
+
+    // Oltre questo numero di prefissi distinti (URL con una cartella diversa per
+    // ogni canale) si condivide solo schema e host
+    static constexpr size_t MAX_PREFIXES = 1 << 16;
+
+    // Stringhe distinte con ricerca per contenuto: nessuna allocazione per quelle già presenti
+    struct InternTable {
+        std::vector<std::string> values;
+        std::vector<uint32_t> slots;
+
+        uint32_t intern(std::string_view value);
+        bool contains(std::string_view value) const;
+        // Ricalcola le posizioni per almeno count valori; da chiamare dopo aver caricato values direttamente
+        void rehash(size_t count);
+        size_t findSlot(std::string_view value) const;
+    };
+
+    std::string_view view(Span span) const { return std::string_view(arena.data() + span.offset, span.length); }
+    static std::string join(std::string_view prefix, std::string_view tail);
+
+    Span store(std::string_view value);
+    uint32_t internPrefix(std::string_view value, std::string_view& tail);
+    void detach();
+
+    template <typename F>
+    void forEachSpanColumn(F&& f) {
+        for (auto* column : {&ids, &chnos, &titles, &urlTails, &logoTails, &tvgNames, &tvgRecs, &catchups, &catchupSources})
+            f(*column);
+    }
+    template <typename F>
+    void forEachSpanColumn(F&& f) const {
+        for (auto* column : {&ids, &chnos, &titles, &urlTails, &logoTails, &tvgNames, &tvgRecs, &catchups, &catchupSources})
+            f(*column);
+    }
+
+    // Colonne, un elemento per canale
+    Column<Span> ids, chnos, titles, urlTails, logoTails, tvgNames, tvgRecs, catchups, catchupSources;
+    Column<uint32_t> groupIds, urlPrefixes, logoPrefixes;
+
+    Column<char> arena;
+
+    InternTable groups;
+    InternTable prefixes;
+
+    // Mantiene valida la mappatura finché lo store (o una sua copia) la usa
+    std::shared_ptr<const MappedFile> file;
+};
+
+}  // namespace tsvitch
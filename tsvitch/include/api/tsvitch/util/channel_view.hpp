@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tsvitch/util/channel_order.hpp"
+#include "tsvitch/util/channel_store.hpp"
+#include "tsvitch/util/group_tree.hpp"
+
+namespace tsvitch {
+
+/**
+ * Canali di uno store condiviso, presi da un intervallo di un array di indici
+ * anch'esso condiviso (o, senza array, da indici consecutivi dello store).
+ * Una copia costa due shared_ptr: canali e indici non vengono mai copiati.
+ */
+class ChannelView {
+public:
+    ChannelView() = default;
+
+    ChannelView(std::shared_ptr<const ChannelStore> store, std::shared_ptr<const std::vector<uint32_t>> indices,
+                size_t first, size_t count)
+        : channels(std::move(store)), indices(std::move(indices)), first(first), count(count) {}
+
+    /// Tutti i canali di indices
+    ChannelView(std::shared_ptr<const ChannelStore> store, std::shared_ptr<const std::vector<uint32_t>> indices)
+        : channels(std::move(store)), indices(std::move(indices)) {
+        count = this->indices ? this->indices->size() : 0;
+    }
+
+    /// Tutti i canali dello store, in ordine
+    explicit ChannelView(std::shared_ptr<const ChannelStore> store) : channels(std::move(store)) {
+        count = channels ? channels->size() : 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /// Indice nello store del canale in posizione position
+    uint32_t index(size_t position) const {
+        return indices ? (*indices)[first + position] : static_cast<uint32_t>(first + position);
+    }
+
+    LiveM3u8 at(size_t position) const { return channels->at(index(position)); }
+
+    const ChannelStore& store() const { return *channels; }
+    const std::shared_ptr<const ChannelStore>& sharedStore() const { return channels; }
+    /// Array di indici condiviso; nullo per indici consecutivi
+    const std::shared_ptr<const std::vector<uint32_t>>& sharedIndices() const { return indices; }
+
+private:
+    std::shared_ptr<const ChannelStore> channels;
+    std::shared_ptr<const std::vector<uint32_t>> indices;
+    size_t first = 0;
+    size_t count = 0;
+};
+
+/**
+ * Canali raggruppati per nome del gruppo mostrato.
+ *
+ * Un'unica permutazione dello store in cui ogni gruppo occupa un intervallo,
+ * costruita con una passata sugli id dei gruppi e poi immutabile: le viste dei
+ * gruppi si ottengono con una ricerca nella tabella, senza allocazioni.
+ *
+ * Con gli ordinamenti (ChannelOrders) c'è una permutazione per ognuno, con gli
+ * stessi intervalli: cambiare ordinamento non riordina né alloca nulla.
+ */
+class ChannelGroups {
+public:
+    ChannelGroups() = default;
+    explicit ChannelGroups(std::shared_ptr<const ChannelStore> store);
+
+    /// Con una permutazione per ogni ordinamento; watched sono le visualizzazioni per "più visti"
+    ChannelGroups(std::shared_ptr<const ChannelStore> store, std::shared_ptr<const ChannelOrders> orders,
+                  const WatchCounts& watched);
+
+    /// Nome mostrato nella lista, con un nome di default per i canali senza gruppo
+    static const std::string& displayName(const std::string& groupTitle);
+
+    /// Nomi dei gruppi in ordine alfabetico
+    const std::vector<std::string>& titles() const { return sortedTitles; }
+    size_t size() const { return sortedTitles.size(); }
+    /// Cartelle dei gruppi secondo i separatori dei nomi, sugli indici di titles()
+    const std::shared_ptr<const GroupTree>& groupTree() const { return tree; }
+
+    size_t channelCount() const { return channels ? channels->size() : 0; }
+    bool empty() const { return channelCount() == 0; }
+
+    /// Canali del gruppo nell'ordinamento richiesto, o in quello dello store se non è stato
+    /// calcolato; vista vuota se il gruppo non esiste
+    ChannelView view(const std::string& title, ChannelOrder order = ChannelOrder::PLAYLIST) const;
+
+    const std::shared_ptr<const ChannelStore>& store() const { return channels; }
+    /// Chiavi degli ordinamenti; nullo se la lista non li ha
+    const std::shared_ptr<const ChannelOrders>& orders() const { return sortKeys; }
+
+private:
+    std::shared_ptr<const ChannelStore> channels;
+    std::shared_ptr<const ChannelOrders> sortKeys;
+    // Una permutazione per ChannelOrder, con i gruppi negli stessi intervalli; quelle
+    // identiche sono condivise e quelle non calcolate nulle
+    std::array<std::shared_ptr<const std::vector<uint32_t>>, CHANNEL_ORDER_COUNT> orderings;
+    std::vector<std::string> sortedTitles;
+    std::shared_ptr<const GroupTree> tree;
+    // Nome mostrato -> primo elemento delle permutazioni e numero di canali
+    std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> ranges;
+};
+
+}  // namespace tsvitch
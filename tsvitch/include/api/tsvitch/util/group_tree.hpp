@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tsvitch {
+
+/**
+ * Gruppi organizzati in cartelle secondo i separatori dei nomi.
+ *
+ * "IT | Sport | HD" diventa la cartella "IT", con dentro la cartella "Sport" e il
+ * gruppo "HD". Separano '|', ':' e '-' con uno spazio accanto ("Al-Jazeera" resta
+ * intero). Una cartella con un solo elemento viene unita a esso, così i gruppi
+ * senza fratelli mantengono il nome completo.
+ *
+ * I nodi sono in un unico array con i figli di ogni nodo consecutivi, ordinati per
+ * nome (a parità prima le cartelle); le radici sono i primi rootCount(). Ogni
+ * cartella conosce già il numero di gruppi che contiene. Si costruisce in background
+ * con l'indice dei gruppi, poi è immutabile.
+ */
+class GroupTree {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        std::string label;
+        uint32_t parent     = NONE;
+        uint32_t depth      = 0;
+        uint32_t firstChild = 0;
+        uint32_t childCount = 0;
+        /// Indice del gruppo nei titoli, NONE per le cartelle
+        uint32_t group = NONE;
+        /// Gruppi nel sottoalbero (1 per un gruppo)
+        uint32_t groupCount = 0;
+
+        bool folder() const { return group == NONE; }
+    };
+
+    GroupTree() = default;
+    explicit GroupTree(const std::vector<std::string>& titles);
+
+    size_t size() const { return nodes.size(); }
+    const Node& node(uint32_t id) const { return nodes[id]; }
+    uint32_t rootCount() const { return roots; }
+    /// Nessuna cartella: la lista dei gruppi resta piatta
+    bool flat() const { return roots == nodes.size(); }
+
+    /// Nodo del gruppo con indice group nei titoli
+    uint32_t nodeOf(uint32_t group) const { return group < leaves.size() ? leaves[group] : NONE; }
+
+    /// Parti del nome separate dai delimitatori, senza spazi attorno e senza quelle vuote.
+    /// ':' tra due cifre non separa ("20:00")
+    static std::vector<std::string_view> split(std::string_view title);
+
+private:
+    std::vector<Node> nodes;
+    std::vector<uint32_t> leaves;
+    uint32_t roots = 0;
+};
+
+/**
+ * Righe visibili di un GroupTree: le radici e i figli delle sole cartelle aperte.
+ * Aprire una cartella inserisce i suoi figli, chiuderla toglie tutto il sottoalbero
+ * visibile: il resto dell'albero non viene mai percorso.
+ */
+class GroupTreeRows {
+public:
+    GroupTreeRows() = default;
+    /// Con una sola cartella tra le radici la apre
+    explicit GroupTreeRows(std::shared_ptr<const GroupTree> tree);
+
+    size_t size() const { return rows.size(); }
+    uint32_t node(size_t row) const { return rows[row]; }
+    bool expanded(uint32_t node) const { return open[node]; }
+    const GroupTree& tree() const { return *groups; }
+
+    /// Apre o chiude la cartella alla riga row
+    void toggle(size_t row);
+
+    /// Apre le cartelle che contengono il gruppo; riga del gruppo, o size() se non esiste
+    size_t reveal(uint32_t group);
+
+    /// Riga del nodo, o size() se non è visibile
+    size_t rowOf(uint32_t node) const;
+
+private:
+    std::shared_ptr<const GroupTree> groups;
+    std::vector<uint32_t> rows;
+    std::vector<bool> open;
+};
+
+}  // namespace tsvitch
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace tsvitch {
+
+/**
+ * Decompressione gzip/zlib in streaming.
+ *
+ * Usata per i file .m3u.gz (locali o remoti senza Content-Encoding): i dati
+ * compressi arrivano a blocchi e quelli decompressi vengono passati subito a
+ * onData, senza mai tenere in memoria il file intero. Più membri gzip
+ * concatenati vengono decompressi in sequenza.
+ */
+class GzipStream {
+public:
+    using DataCallback = std::function<void(std::string_view)>;
+
+    explicit GzipStream(DataCallback onData);
+    ~GzipStream();
+
+    /// Decomprime un blocco; false se i dati non sono validi
+    bool feed(std::string_view chunk);
+
+    /// true se il buffer inizia con l'intestazione gzip
+    static bool isGzip(std::string_view data);
+
+    /// true se la decompressione è disponibile in questa build
+    static bool supported();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+    DataCallback onData;
+};
+
+}  // namespace tsvitch
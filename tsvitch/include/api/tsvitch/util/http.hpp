@@ -13,6 +13,9 @@
 #include "config/server_config.h"
 
 #include <pystring.h>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
 
 namespace tsvitch {
 
@@ -42,6 +45,18 @@ public:
 
     static void setProxy(const std::string& proxyUrl);
 
+    /// Codifiche di trasferimento supportate dalla libcurl in uso, per il log. cpr le annuncia già
+    /// tutte in Accept-Encoding e libcurl le decomprime prima del write callback
+    static std::string supportedEncodings();
+
+    /**
+     * Sessione persistente del thread chiamante, per molte richieste brevi (i loghi).
+     * Ogni thread riusa la propria connessione; DNS e sessioni TLS sono condivisi tra i thread
+     * e restano disponibili anche quando il thread che li ha creati termina.
+     * Ogni richiesta deve impostare tutte le opzioni che usa: la sessione conserva le precedenti.
+     */
+    static cpr::Session& threadSession();
+
     static void __cpr_post(const std::string& url, const cpr::Parameters& parameters = {},
                        const cpr::Body& body = cpr::Body{""},
                        const std::function<void(const cpr::Response&)>& callback = nullptr,
@@ -95,6 +110,60 @@ public:
             HTTP::VERIFY);
     }
 
+    /**
+     * GET in streaming: il corpo non viene accumulato in r.text ma passato a onData
+     * man mano che arriva, già decompresso da libcurl se il server usa Content-Encoding.
+     * onData restituisce false per interrompere il trasferimento.
+     * Solo il corpo di una risposta 200 arriva a onData: quello di un errore viene scartato
+     * e il codice arriva a error. Anche 304 viene passato a callback, per le richieste condizionali.
+     */
+    static void __cpr_get_stream(const std::string& url, int timeout, const cpr::Header& headers,
+                                 const std::function<bool(std::string_view)>& onData,
+                                 const std::function<void(const cpr::Response&)>& callback = nullptr,
+                                 const ErrorCallback& error = nullptr) {
+        // Stato dell'ultima risposta ricevuta: con i redirect arrivano più righe di stato e
+        // vale quella che precede il corpo. Header e corpo arrivano sullo stesso thread
+        auto status = std::make_shared<long>(0);
+        cpr::GetCallback(
+            [callback, error](const cpr::Response& r) {
+                if (r.error) {
+                    ERROR_MSG(r.error.message, -1);
+                    return;
+                } else if (r.status_code != 200 && r.status_code != 304) {
+                    ERROR_MSG("Network error. [Status code: " + std::to_string(r.status_code) + " ]", r.status_code);
+                    return;
+                }
+                callback(r);
+            },
+            cpr::Url{url},
+            cpr::HeaderCallback{[status](const auto& header, auto&&...) -> bool {
+                const std::string_view line(header);
+                if (line.size() > 9 && line.compare(0, 5, "HTTP/") == 0) {
+                    const size_t space = line.find(' ');
+                    if (space != std::string_view::npos)
+                        *status = std::strtol(std::string(line.substr(space + 1, 3)).c_str(), nullptr, 10);
+                }
+                return true;
+            }},
+            cpr::WriteCallback{[onData, status](const auto& data, auto&&...) -> bool {
+                return *status != 200 || onData(data);
+            }},
+            cpr::HttpVersion{cpr::HttpVersionCode::VERSION_2_0_TLS},
+            cpr::Timeout{timeout},
+            headers,
+            HTTP::COOKIES,
+            HTTP::PROXIES,
+            HTTP::VERIFY);
+    }
+
+    /// Aggiunge If-None-Match / If-Modified-Since agli header di base
+    static cpr::Header conditionalHeaders(const std::string& etag, const std::string& lastModified) {
+        cpr::Header headers = HTTP::HEADERS;
+        if (!etag.empty()) headers["If-None-Match"] = etag;
+        if (!lastModified.empty()) headers["If-Modified-Since"] = lastModified;
+        return headers;
+    }
+
     template <typename ReturnType>
     static int parseJson(const cpr::Response& r, const std::function<void(ReturnType)>& callback = nullptr,
                           const ErrorCallback& error = nullptr) {
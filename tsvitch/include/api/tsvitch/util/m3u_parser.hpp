@@ -0,0 +1,72 @@
+#pragma once
+
+#include <deque>
+#include <future>
+#include <string>
+#include <string_view>
+
+#include "tsvitch/result/home_live_result.h"
+
+namespace tsvitch {
+
+/**
+ * Parser M3U a passata singola.
+ *
+ * Lavora su std::string_view e scrive i canali direttamente nel vettore di
+ * destinazione: nessun nodo JSON intermedio e una sola sanitizzazione per campo.
+ * Un canale viene emesso quando la riga URL segue il suo #EXTINF.
+ *
+ * Con feed()/finish() il contenuto può arrivare a blocchi arbitrari (es. dal
+ * write callback di cpr): viene conservata solo l'ultima riga incompleta.
+ *
+ * Con workers > 1 il contenuto viene diviso in blocchi che iniziano sempre con
+ * una riga #EXTINF, analizzati in parallelo e concatenati nell'ordine originale:
+ * il risultato è identico a quello dell'analisi seriale.
+ */
+class M3uParser {
+public:
+    /// Numero di thread usati per l'analisi delle playlist, impostato dalla configurazione
+    inline static size_t PARSE_THREADS = 1;
+
+    explicit M3uParser(LiveM3u8ListResult& output, size_t workers = 1) : output(output), workers(workers) {}
+
+    /// Analizza un buffer completo (una o più righe)
+    void parse(std::string_view content);
+
+    /// Analizza una singola riga, senza terminatore
+    void parseLine(std::string_view line);
+
+    /// Analizza un blocco di dati in streaming; le righe spezzate vengono completate al blocco successivo
+    void feed(std::string_view chunk);
+
+    /// Analizza l'eventuale ultima riga rimasta senza terminatore
+    void finish();
+
+    /// Estrae attributi e titolo da una riga #EXTINF (senza il prefisso "#EXTINF:")
+    static void parseExtInf(std::string_view extinf, LiveM3u8& entry);
+
+    /// Stima il numero di canali presenti nel buffer, per pre-allocare il risultato
+    static size_t estimateCount(std::string_view content);
+
+    static LiveM3u8ListResult parseAll(std::string_view content, size_t workers = 1);
+
+private:
+    /// Accoda un blocco completo all'analisi parallela
+    void dispatchBlock(std::string block);
+
+    /// Sposta in output, in ordine, i blocchi pronti; attende finché in coda ne restano al più keep
+    void collectBlocks(size_t keep);
+
+    LiveM3u8ListResult& output;
+    LiveM3u8 current;
+    bool hasExtInf = false;
+
+    std::string partialLine;
+    bool firstChunk = true;
+
+    size_t workers;
+    std::string pendingBlock;
+    std::deque<std::future<LiveM3u8ListResult>> blocks;
+};
+
+}  // namespace tsvitch
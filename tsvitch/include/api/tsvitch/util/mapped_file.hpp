@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace tsvitch {
+
+/**
+ * Contenuto di un file in sola lettura, allineato a 8 byte.
+ *
+ * Dove disponibile (Linux, macOS, Android, iOS) il file viene mappato con mmap:
+ * le pagine vengono lette solo quando servono e la mappatura resta valida
+ * anche se nel frattempo il file viene sostituito o cancellato. Su Switch,
+ * PSV, PS4 e Windows (dove un file mappato non può essere sostituito) viene
+ * letto per intero con una sola lettura.
+ */
+class MappedFile {
+public:
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// nullptr se il file non esiste o non è leggibile
+    static std::shared_ptr<const MappedFile> open(const std::string& path);
+
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+    bool mapped() const { return isMapped; }
+
+private:
+    MappedFile() = default;
+
+    const char* ptr = nullptr;
+    size_t length   = 0;
+    bool isMapped   = false;
+    std::unique_ptr<uint64_t[]> buffer;
+};
+
+}  // namespace tsvitch
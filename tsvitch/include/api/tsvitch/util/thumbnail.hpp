@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tsvitch {
+
+/**
+ * Immagine ridotta alla dimensione della vista che la mostra.
+ *
+ * RGBA con alfa premoltiplicato (da caricare con NVG_IMAGE_PREMULTIPLIED) e un
+ * bordo trasparente su ogni lato. Riduzione, premoltiplicazione e bordo sono
+ * fatti in un'unica passata sull'immagine decodificata, che può essere liberata
+ * subito dopo: in memoria video resta solo la miniatura.
+ *
+ * encode() produce il formato salvato nella cache su disco (compresso con zlib
+ * se disponibile): rileggerlo non richiede di decodificare né ridurre l'immagine.
+ */
+struct Thumbnail {
+    /// Bordo compreso
+    int width  = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+
+    bool empty() const { return pixels.empty(); }
+
+    /// Riduce rgba (width x height, alfa non premoltiplicato) quanto basta per coprire
+    /// boxWidth x boxHeight, senza mai ingrandire: ogni pixel è la media dell'area che copre
+    static Thumbnail fromRGBA(const uint8_t* rgba, int width, int height, int boxWidth, int boxHeight, int border);
+
+    std::string encode() const;
+    /// false se data non è una miniatura valida
+    static bool decode(std::string_view data, Thumbnail& out);
+};
+
+}  // namespace tsvitch
@@ -4,7 +4,28 @@
 #include <filesystem>
 #include <nlohmann/json.hpp>
 #include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "api/tsvitch/result/home_live_result.h"
+#include "api/tsvitch/util/channel_store.hpp"
+#include "api/tsvitch/util/channel_order.hpp"
+
+namespace tsvitch {
+struct ChannelDiff;
+}
+
+// Validatori HTTP e hash del contenuto da cui è stata generata la cache binaria
+struct CacheValidators {
+    std::string source;
+    std::string etag;
+    std::string lastModified;
+    std::string contentHash;
+
+    bool empty() const { return etag.empty() && lastModified.empty() && contentHash.empty(); }
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(CacheValidators, source, etag, lastModified, contentHash);
 
 class ChannelManager {
 public:
@@ -14,24 +35,115 @@ public:
     tsvitch::LiveM3u8ListResult load() const;
     
     // Binary cache functions (faster than JSON)
-    void saveBinary(const tsvitch::LiveM3u8ListResult& channels) const;
-    tsvitch::LiveM3u8ListResult loadBinary() const;
+    // false se la cache su disco non è stata sostituita
+    bool saveBinary(const tsvitch::ChannelStore& channels) const;
+    tsvitch::ChannelStore loadBinary() const;
     
-    // Nuove funzioni per cache intelligente
-    bool isCacheValid(int maxAgeMinutes = 43200) const; // Cache valida per 1 mese di default (43200 minuti)
-    void saveWithTimestamp(const tsvitch::LiveM3u8ListResult& channels) const;
-    tsvitch::LiveM3u8ListResult loadIfValid(int maxAgeMinutes = 43200) const;
+    // Nuove funzioni per cache intelligente. Con maxAgeMinutes negativo vale la scadenza
+    // configurata (hardExpiryMinutes): una cache più vecchia non viene più mostrata
+    bool isCacheValid(int maxAgeMinutes = -1) const;
+    void saveWithTimestamp(const tsvitch::ChannelStore& channels) const;
+    tsvitch::ChannelStore loadIfValid(int maxAgeMinutes = -1) const;
+
+    // Stale-while-revalidate: la cache entro la scadenza viene sempre mostrata subito,
+    // e se è più vecchia di revalidateAfterMinutes si scarica la lista in background
+    static int hardExpiryMinutes();
+    static int revalidateAfterMinutes(); // Xtream: 5 min, M3U8: 15 min
+    bool needsRevalidation() const { return !isCacheValid(revalidateAfterMinutes()); }
+
+    // Gruppo della directory della cache binaria: nome (group-title) e posizione dei suoi canali
+    struct CachedGroup {
+        std::string name;
+        uint32_t first;
+        uint32_t count;
+    };
+    // Directory dei gruppi, senza leggere i canali; vuota se la cache non è valida,
+    // non ha una directory o ha modifiche nel journal (serve allora loadIfValid)
+    std::vector<CachedGroup> loadGroupIndexIfValid(int maxAgeMinutes = -1) const;
+    // Canali dei soli gruppi indicati, letti dalla cache senza caricare gli altri
+    tsvitch::ChannelStore loadGroups(const std::vector<CachedGroup>& groups) const;
+
+    // Aggiornamento incrementale: accoda al journal della cache binaria solo i canali
+    // aggiunti o modificati rispetto alla lista salvata; se il journal diventa troppo
+    // grande (o non corrisponde alla cache) riscrive tutto come saveWithTimestamp
+    void saveDeltaWithTimestamp(const tsvitch::ChannelStore& channels, const tsvitch::ChannelDiff& diff) const;
+
+    // Ordinamenti della lista (per nome, numero e data di comparsa), in un file accanto
+    // alla cache: calcolarli richiede di ordinare tutti i canali
+    void saveOrders(const tsvitch::ChannelOrders& orders) const;
+    // Ordinamenti salvati per channels; se mancano o sono di un'altra lista vengono
+    // calcolati (tutti i canali risultano aggiunti adesso) e salvati
+    std::shared_ptr<const tsvitch::ChannelOrders> loadOrders(const tsvitch::ChannelStore& channels) const;
+
+    // Richieste condizionali: i validatori della risposta scaricata vengono
+    // salvati da saveWithTimestamp insieme ai canali a cui si riferiscono
+    CacheValidators loadValidators(const std::string& source) const;
+    void setPendingValidators(const CacheValidators& validators) const;
+    // La sorgente non è cambiata (304 o stesso hash): aggiorna solo il timestamp
+    void touchTimestamp() const;
 
+    // Ogni sorgente (URL M3U8, oppure server e utente Xtream) ha la sua cache, in una
+    // cartella dal nome ricavato dall'hash della sorgente: tornare a una sorgente già
+    // usata non richiede di scaricare di nuovo la lista. Le sorgenti usate meno di
+    // recente vengono eliminate oltre MAX_SOURCE_SLOTS o SOURCE_SLOTS_BUDGET byte
+    static std::string currentSource();
+    // Cache della sorgente configurata
     static ChannelManager* get();
 
+    // Sul thread principale, dopo il caricamento della configurazione e a ogni modifica di
+    // sorgente, modalità IPTV o scadenza: i task in background usano questi valori invece di
+    // leggere ProgramConfig, che nel frattempo il thread principale può modificare
+    static void updateSettings();
+
     void remove() const;
 
 private:
+    // Un gestore per ogni sorgente usata nella sessione, mai eliminato: i puntatori restano
+    // validi per i task in background
+    inline static std::mutex managersMutex_;
+    inline static std::unordered_map<std::string, std::unique_ptr<ChannelManager>> managers_;
+
+    inline static std::mutex settingsMutex_;
+    inline static std::string source_;
+    inline static std::atomic<int> hardExpiryMinutes_{0};
+    inline static std::atomic<int> revalidateAfterMinutes_{15};
+
+    // Cartella che contiene le cache di tutte le sorgenti; vuota per una cache singola
+    std::filesystem::path slotsRoot_;
     std::filesystem::path file_;
     std::filesystem::path binaryFile_;
     std::filesystem::path timestampFile_;
+    std::filesystem::path metaFile_;
+    std::filesystem::path journalFile_;
+    std::filesystem::path ordersFile_;
+
+    // Serializza le scritture della cache (completa o incrementale)
+    mutable std::mutex saveMutex_;
+
+    mutable std::mutex validatorsMutex_;
+    mutable CacheValidators pendingValidators_;
+
+    void saveTimestamp() const;
+    // Segna la cache come usata adesso ed elimina quelle delle sorgenti meno recenti
+    void markUsed() const;
+    void evictSlots() const;
+    // Sposta nella cartella della sorgente la cache di una versione precedente, salvata in dir
+    void adoptLegacyCache(const std::filesystem::path& dir) const;
+    // Timestamp e validatori della risposta a cui corrispondono i canali appena salvati
+    void commitMetadata() const;
+    // Salvataggio fallito: i validatori non descrivono più la cache rimasta, la prossima
+    // richiesta non deve essere condizionale
+    void discardMetadata() const;
+
+    // Cache binaria delle versioni senza intestazione, convertita dopo la lettura
+    tsvitch::ChannelStore loadLegacyBinary() const;
+
+    bool writeJournalSegment(const tsvitch::ChannelStore& channels, const tsvitch::ChannelDiff& diff) const;
+    bool applyJournal(tsvitch::ChannelStore& channels) const;
     
     // Helper functions for binary serialization
     void writeString(std::ofstream& out, const std::string& str) const;
     std::string readString(std::ifstream& in) const;
+    // Riusa le stringhe di channel, senza allocazioni per i campi che ci stanno già
+    void readChannel(std::ifstream& in, tsvitch::LiveM3u8& channel) const;
 };
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
+#include <atomic>
 #include <deque>
 #include <filesystem>
+#include <mutex>
 #include <string>
 #include <nlohmann/json.hpp>
 #include "api/tsvitch/result/home_live_result.h" // aggiungi questo include per LiveM3u8
+#include "api/tsvitch/util/channel_order.hpp"
 
 class HistoryManager {
 public:
@@ -15,6 +18,11 @@ public:
     // Restituisce gli ultimi X canali completi (default: 10)
     std::deque<tsvitch::LiveM3u8> recent(std::size_t limit = 10) const;
 
+    // Quante volte è stato aperto ogni canale (per URL), per l'ordinamento "più visti".
+    // Copia: può essere letta dai thread in background
+    tsvitch::WatchCounts watchCounts() const;
+
+    // Cronologia e conteggi, subito (all'uscita)
     void save() const;
     void load();
 
@@ -23,6 +31,15 @@ public:
 
 private:
     std::filesystem::path file_;
+    std::filesystem::path countsFile_;
     std::deque<tsvitch::LiveM3u8> ring_; // cambia il tipo da string a LiveM3u8
+    tsvitch::WatchCounts counts_;
+    mutable std::mutex countsMutex_;
+    mutable std::mutex countsFileMutex_;
+    mutable std::atomic<bool> countsSaveQueued_{false};
+
+    // I conteggi vengono riscritti in background, non a ogni add sul thread principale
+    void scheduleCountsSave() const;
+    void saveCounts() const;
     static constexpr std::size_t MAX_ITEMS = 10;
 };
\ No newline at end of file
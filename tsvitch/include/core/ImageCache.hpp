@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+// Immagine salvata: il contenuto è nel file blobs/<hash>, condiviso dagli URL con gli stessi byte
+struct ImageCacheEntry {
+    std::string url;
+    std::string hash;  // MD5 del contenuto, in esadecimale
+    uint64_t size    = 0;
+    int64_t expires  = 0;  // secondi dall'epoch: dopo va riconvalidata
+    int64_t lastUsed = 0;
+    std::string etag;
+    std::string lastModified;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ImageCacheEntry, url, hash, size, expires, lastUsed, etag, lastModified);
+
+// Intestazioni della risposta che decidono per quanto un'immagine resta valida
+struct ImageCacheHeaders {
+    std::string cacheControl;
+    std::string etag;
+    std::string lastModified;
+};
+
+/**
+ * Cache su disco delle immagini scaricate (i loghi dei canali), nella cartella
+ * "images" della configurazione. ImageHelper vi salva le miniature già ridotte
+ * (Thumbnail), con chiave URL e dimensione della vista.
+ *
+ * Ogni file ha come nome l'hash del contenuto: URL diversi con la stessa immagine
+ * occupano spazio una volta sola. File e indice (index.json) vengono scritti in un
+ * file temporaneo e poi rinominati: non si legge mai un file a metà. L'indice
+ * viene riscritto al più ogni INDEX_SAVE_INTERVAL secondi e all'uscita.
+ *
+ * Oltre MAX_SIZE_MB si eliminano le immagini usate meno di recente. Un'immagine
+ * scaduta secondo Cache-Control viene comunque restituita, segnata da riconvalidare
+ * con ETag / Last-Modified.
+ */
+class ImageCache {
+public:
+    explicit ImageCache(const std::filesystem::path& dir);
+    ~ImageCache();
+
+    static ImageCache* get();
+
+    struct Hit {
+        std::string data;
+        bool stale = false;
+        std::string etag;
+        std::string lastModified;
+    };
+
+    // Immagine salvata per url; vuoto se manca o se la cache è disattivata
+    std::optional<Hit> find(const std::string& url);
+
+    // Risposta 200: salva il contenuto, se Cache-Control lo consente
+    void store(const std::string& url, const std::string& data, const ImageCacheHeaders& headers);
+
+    // Risposta 304: il contenuto salvato è ancora valido, con una nuova scadenza
+    void refresh(const std::string& url, const ImageCacheHeaders& headers);
+
+    // Contenuto salvato non più leggibile come immagine
+    void remove(const std::string& url);
+
+    // Limite in MB; 0 disattiva la cache e la svuota
+    static void setMaxSize(size_t megabytes);
+    inline static size_t MAX_SIZE_MB = 100;
+
+    // Senza max-age un'immagine resta valida una settimana
+    static constexpr int64_t DEFAULT_MAX_AGE     = 7 * 24 * 3600;
+    static constexpr int64_t INDEX_SAVE_INTERVAL = 10;
+
+private:
+    struct Blob {
+        uint64_t size = 0;
+        uint32_t refs = 0;
+    };
+
+    std::filesystem::path blobPath(const std::string& hash) const { return blobsDir_ / hash; }
+
+    // Scrive il file del blob con un nome temporaneo e lo rinomina; senza mutex_
+    bool writeBlob(const std::string& hash, const std::string& data);
+
+    // Con mutex_ bloccato
+    void addEntry(const std::string& url, const std::string& hash, uint64_t size, int64_t expires, int64_t now,
+                  const ImageCacheHeaders& headers);
+    void erase(std::unordered_map<std::string, ImageCacheEntry>::iterator it);
+    void trim(uint64_t maxBytes);
+
+    void load();
+    // Salva l'indice se è cambiato e, salvo force, se è passato INDEX_SAVE_INTERVAL dall'ultima volta
+    void saveIndex(bool force);
+
+    std::filesystem::path dir_;
+    std::filesystem::path blobsDir_;
+    std::filesystem::path indexFile_;
+
+    std::unordered_map<std::string, ImageCacheEntry> entries_;
+    std::unordered_map<std::string, Blob> blobs_;
+    uint64_t totalBytes_ = 0;
+    bool dirty_          = false;
+    int64_t lastSave_    = 0;
+    std::mutex mutex_;
+    std::mutex saveMutex_;
+};
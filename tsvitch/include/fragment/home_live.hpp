@@ -4,9 +4,11 @@
 
 #include "view/auto_tab_frame.hpp"
 #include "presenter/home_live.hpp"
+#include "tsvitch/util/channel_view.hpp"
+#include "tsvitch/util/channel_search.hpp"
 
-#include <map>
-#include <mutex>
+#include <memory>
+#include <unordered_map>
 
 typedef brls::Event<std::string> UpdateSearchEvent;
 
@@ -20,7 +22,11 @@ class HomeLive : public AttachedView, public HomeLiveRequest {
 public:
     HomeLive();
 
-    void onLiveList(tsvitch::LiveM3u8ListResult result, bool firstLoad) override;
+    void onLiveList(tsvitch::ChannelGroups result, bool firstLoad) override;
+
+    void onLiveListPreview(tsvitch::ChannelGroups result) override;
+
+    void onLiveListNotModified() override;
 
     ~HomeLive() override;
 
@@ -47,12 +53,62 @@ public:
     static View *create();
 
 private:
+    // preview: lista parziale ancora in download, non salvata e senza precaricamento dei gruppi
+    void showLiveList(tsvitch::ChannelGroups result, bool firstLoad, bool preview);
+
+    // Aggiorna la lista mostrata applicando solo le differenze con quella nuova
+    void applyLiveListDelta(tsvitch::ChannelGroups result);
+
+    // Mostra groupTree nella lista dei gruppi e seleziona selectedIndex (indice in groupTitles)
+    void showGroupList(size_t selectedIndex, bool persistSelection);
+
+    // Mostra nella griglia i canali del gruppo
+    void showGroup(const std::string &group);
+
+    // Indice di ricerca di channelsList, costruito in background
+    void buildSearchIndex();
+
+    // Ordinamenti di channelsList, calcolati e salvati in background
+    void buildChannelOrders();
+
+    // Mostra il gruppo visibile nell'ordinamento channelOrder
+    void applyChannelOrder();
+
+    // Risultati della ricerca generation: la prima schermata subito, il resto al frame successivo
+    void showSearchResults(uint64_t generation, tsvitch::ChannelView results);
+
+    // Cambio di playlist, modalità o account Xtream: mostra la cache della nuova sorgente se c'è
+    void switchSource();
+
+    // Cache all'avvio (in background): mostra subito il gruppo selezionato, poi restituisce la lista completa
+    tsvitch::ChannelGroups loadCachedChannels(const std::shared_ptr<std::atomic<bool>> &validityFlag);
+
+    // Solo i canali del gruppo selectedIndex, con tutti i gruppi della cache nella lista
+    void showCachedGroup(tsvitch::ChannelGroups channels, std::vector<std::string> titles,
+                         std::shared_ptr<const tsvitch::GroupTree> tree, size_t selectedIndex);
+
     int selectedGroupIndex = 0;
     bool isSearchActive    = false;
     bool isInitialLoadInProgress = false;
-    tsvitch::LiveM3u8ListResult channelsList;
-    std::map<std::string, tsvitch::LiveM3u8ListResult> groupCache;
-    std::mutex groupCacheMutex;
+    bool showingPreview          = false;
+    // channelsList contiene solo partialGroup, letto dalla directory della cache
+    bool showingPartial = false;
+    std::string partialGroup;
+    // Condivisa in sola lettura con le griglie, il player e i task in background
+    std::shared_ptr<const tsvitch::ChannelStore> channelsList = std::make_shared<const tsvitch::ChannelStore>();
+    std::vector<std::string> groupTitles;
+    // Cartelle di groupTitles mostrate nella lista dei gruppi
+    std::shared_ptr<const tsvitch::GroupTree> groupTree;
+    // Canali di ogni gruppo come intervalli di un'unica permutazione di channelsList, aggiornati solo sul main thread
+    tsvitch::ChannelGroups channelGroups;
+    // Incrementato a ogni sostituzione di channelsList: i task in background costruiti sulla lista precedente si fermano
+    std::atomic<uint64_t> listGeneration{0};
+    // Ordinamento dei canali nei gruppi, dalle impostazioni
+    tsvitch::ChannelOrder channelOrder = tsvitch::ChannelOrder::PLAYLIST;
+    // Indice di ricerca della lista completa; nullo finché non è pronto
+    std::shared_ptr<const tsvitch::ChannelSearchIndex> searchIndex;
+    // Incrementato a ogni ricerca e alla sua chiusura: le ricerche precedenti si interrompono
+    std::atomic<uint64_t> searchGeneration{0};
     std::shared_ptr<std::atomic<bool>> validityFlag;
     brls::Event<>::Subscription exitEventSubscription;
     bool hasExitSubscription = false;
@@ -5,14 +5,21 @@
 #pragma once
 
 #include "tsvitch/result/home_live_result.h"
+#include "tsvitch/util/channel_view.hpp"
 #include "presenter/presenter.h"
 #include <memory>
 #include <atomic>
 
 class HomeLiveRequest : public Presenter {
 public:
-    // Pass by value so callers can move large vectors without extra copies
-    virtual void onLiveList(tsvitch::LiveM3u8ListResult result, bool firstLoad);
+    // Canali già raggruppati dal thread che li ha letti: sul main thread resta solo lo scambio
+    virtual void onLiveList(tsvitch::ChannelGroups result, bool firstLoad);
+
+    // Primi canali della playlist ricevuti mentre il download è ancora in corso
+    virtual void onLiveListPreview(tsvitch::ChannelGroups result);
+
+    // La sorgente non è cambiata rispetto alla cache (304 o stesso contenuto)
+    virtual void onLiveListNotModified();
 
     virtual void onError(const std::string& error) = 0;
 
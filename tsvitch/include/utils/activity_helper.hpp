@@ -2,12 +2,17 @@
 #include <string>
 #include <borealis/core/event.hpp> // aggiungi questa riga
 #include "api/tsvitch/result/home_live_result.h" // aggiungi questa riga
+#include "api/tsvitch/util/channel_view.hpp"
+#include <memory>
 
 class Intent {
 public:
 
     static void openLive(const std::vector<tsvitch::LiveM3u8>& channelList, size_t index, std::function<void()> onClose);
 
+    /// Apre il canale index della vista, condividendo la lista invece di copiarla
+    static void openLive(tsvitch::ChannelView channels, size_t index, std::function<void()> onClose);
+
     static void openPgcFilter(const std::string& filter);
 
     static void openSettings(std::function<void()> onClose = nullptr);
@@ -55,3 +60,5 @@ inline brls::Event<> OnProxyUrlChanged;
 inline brls::Event<> OnIPTVModeChanged;
 // Evento globale per notificare il cambio Xtream
 inline brls::Event<XtreamData> OnXtreamChanged;
+// Evento globale per notificare il cambio di ordinamento dei canali
+inline brls::Event<> OnChannelOrderChanged;
@@ -74,6 +74,7 @@ enum class SettingItem {
     M3U8_URL_ITEM,
     PROXY_URL_ITEM,
     M3U8_TIMEOUT,
+    M3U8_PARSE_THREADS,
 
     TLS_VERIFY,
     UP_FILTER,
@@ -88,6 +89,12 @@ enum class SettingItem {
     XTREAM_ENABLED,
 
     GROUP_SELECTED_INDEX,
+
+    CHANNEL_CACHE_MAX_AGE,
+
+    CHANNEL_ORDER,  // tsvitch::ChannelOrder
+
+    IMAGE_DISK_CACHE,  // MB
 };
 
 class APPVersion : public brls::Singleton<APPVersion> {
@@ -3,9 +3,13 @@
 #pragma once
 
 #include <cpr/cpr.h>
+#include <chrono>
 #include <ctime>
+#include <functional>
+#include <optional>
 #include <random>
 #include <unordered_map>
+#include <vector>
 #include <borealis/views/image.hpp>
 
 class ImageHelper {
@@ -29,6 +33,17 @@ public:
     static void clear(brls::Image* view);
 
     static void setRequestThreads(size_t num);
+
+    // Ordine delle richieste in attesa: prima il livello, poi la distanza dal centro della vista
+    // che scorre, poi l'ordine di arrivo
+    enum class Tier { VISIBLE, PREFETCH, FAR };
+    struct Priority {
+        Tier tier      = Tier::VISIBLE;
+        float distance = 0;
+    };
+
+    // Sul thread principale: nuova priorità delle richieste in attesa per cui rank ne restituisce una
+    static void prioritize(const std::function<std::optional<Priority>(brls::Image*)>& rank);
 #ifdef USE_WEBP
 #ifdef __PSV__
     inline static std::string h_ext           = "@224w_126h_1c.webp";
@@ -76,20 +91,50 @@ public:
 #endif
 
     inline static size_t REQUEST_THREADS = 1;
+    // Miniatura quando la vista non ha ancora una dimensione; le altre sono multipli di THUMBNAIL_STEP
+    inline static int THUMBNAIL_SIZE = 256;
+    inline static int THUMBNAIL_STEP = 32;
+    // Un URL che non si è riusciti a scaricare non viene richiesto di nuovo per questo tempo
+    inline static int FAILED_RETRY_SECONDS = 600;
+    inline static size_t FAILED_URLS_LIMIT = 1024;
 
 protected:
     virtual void requestImage();
 
     void clean();
 
+    // Sul thread di download: esegue la richiesta in attesa con la priorità più alta
+    static void runNext();
+
+    // Fine senza immagine: se cancellata la richiesta passa alla prossima vista che aspetta lo stesso
+    // logo, altrimenti l'URL finisce tra quelli falliti e tutte le viste restano col segnaposto
+    void finishFailed();
+
+    // Viste in attesa dello stesso logo, tolte dalle richieste in corso
+    std::vector<ImageHelper*> takeWaiting();
+
+    static bool before(const Priority& a, const Priority& b);
+
 private:
     bool isCancel{};
     brls::Image* imageView;
     std::string imageUrl;
+    // URL e dimensione della miniatura: chiave delle texture e della cache su disco
+    std::string cacheKey;
+    int boxWidth  = 0;
+    int boxHeight = 0;
     Pool::iterator currentIter;
+    Priority priority;
+    uint64_t sequence = 0;
 
     inline static std::unordered_map<brls::Image*, Pool::iterator> requestMap;
 
     inline static Pool requestPool;
+    // Richieste non ancora iniziate: una vista cancellata esce da qui senza toccare la rete
+    inline static std::vector<ImageHelper*> pending;
+    inline static uint64_t nextSequence = 0;
+    // Viste per ogni logo in arrivo (chiave cacheKey): la prima lo scarica per tutte
+    inline static std::unordered_map<std::string, std::vector<ImageHelper*>> inflight;
+    inline static std::unordered_map<std::string, std::chrono::steady_clock::time_point> failedUrls;
     inline static std::mutex requestMutex;
 };
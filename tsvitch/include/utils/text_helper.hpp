@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace tsvitch {
+
+/**
+ * Pulisce il testo rimuovendo caratteri che potrebbero causare problemi di rendering.
+ *
+ * In una sola passata: rimuove i caratteri di controllo, comprime gli spazi,
+ * elimina quelli iniziali e finali e sostituisce le sequenze UTF-8 non valide
+ * con U+FFFD. Se searchKey non è nullo vi scrive anche la versione minuscola
+ * (case folding) del risultato, da usare per la ricerca.
+ */
+std::string sanitizeText(std::string_view text, std::string* searchKey = nullptr);
+
+/// Chiave di ricerca del testo: come sanitizeText, ma in minuscolo
+std::string foldText(std::string_view text);
+
+/// Come foldText, ma accoda il risultato a out (senza allocazioni se c'è già spazio)
+void appendFoldedText(std::string_view text, std::string& out);
+
+}  // namespace tsvitch
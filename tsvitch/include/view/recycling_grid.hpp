@@ -154,6 +154,9 @@ private:
     brls::Label* hintLabel;
 
     brls::Rect renderedFrame;
+    // Stato all'ultimo aggiornamento delle priorità: si ripete solo se cambia
+    float prioritizedOffset = -1;
+    size_t prioritizedCells = 0;
     std::vector<float> cellHeightCache;
     std::map<std::string, std::vector<RecyclingGridItem*>*> queueMap;
     std::map<std::string, std::function<RecyclingGridItem*(void)>> allocationMap;
@@ -164,6 +167,9 @@ private:
 
     void itemsRecyclingLoop();
 
+    // Priorità dei loghi in attesa secondo la posizione delle celle rispetto a visibleFrame
+    void prioritizeImages(const brls::Rect& visibleFrame);
+
     void addCellAt(size_t index, bool downSide);
 };
 
@@ -33,8 +33,13 @@ using namespace brls::literals;
 
 LiveActivity::LiveActivity(const std::vector<tsvitch::LiveM3u8>& channels, size_t startIndex,
                            std::function<void()> onClose)
-    : onCloseCallback(onClose), channelList(channels), currentChannelIndex(startIndex) {
-    this->liveData = channelList[currentChannelIndex];
+    : LiveActivity(tsvitch::ChannelView(
+                       std::make_shared<const tsvitch::ChannelStore>(tsvitch::ChannelStore::fromList(channels))),
+                   startIndex, std::move(onClose)) {}
+
+LiveActivity::LiveActivity(tsvitch::ChannelView channels, size_t startIndex, std::function<void()> onClose)
+    : onCloseCallback(std::move(onClose)), channels(std::move(channels)), currentChannelIndex(startIndex) {
+    this->liveData = this->channels.at(currentChannelIndex);
     brls::Logger::debug("LiveActivity: create: {}", liveData.title);
     ShaderHelper::instance().clearShader(false);
 }
@@ -78,11 +83,11 @@ void LiveActivity::onContentAvailable() {
             if (this->video->isOSDLock()) {
                 this->video->toggleOSD();
             } else {
-                if (currentChannelIndex + 1 < channelList.size()) {
+                if (currentChannelIndex + 1 < channels.size()) {
                     this->video->stop();
 
                     currentChannelIndex++;
-                    this->liveData = channelList[currentChannelIndex];
+                    this->liveData = channels.at(currentChannelIndex);
                     this->video->setTitle(liveData.title);
                     this->video->setFavoriteIcon(FavoriteManager::get()->isFavorite(liveData.url));
                     this->getAdUrlFromServer([&](const std::string& adUrl) {
@@ -112,7 +117,7 @@ void LiveActivity::onContentAvailable() {
                     this->video->stop();
 
                     currentChannelIndex--;
-                    this->liveData = channelList[currentChannelIndex];
+                    this->liveData = channels.at(currentChannelIndex);
                     this->video->setTitle(liveData.title);
                     this->video->setFavoriteIcon(FavoriteManager::get()->isFavorite(liveData.url));
                     this->getAdUrlFromServer([&](const std::string& adUrl) {
@@ -9,6 +9,7 @@
 #include <cpr/cpr.h>
 
 #include "tsvitch.h"
+#include "tsvitch/util/m3u_parser.hpp"
 #include "activity/settings_activity.hpp"
 #include "fragment/setting_network.hpp"
 #include "fragment/test_rumble.hpp"
@@ -19,6 +20,8 @@
 #include "view/text_box.hpp"
 #include "view/selector_cell.hpp"
 #include "view/mpv_core.hpp"
+#include "core/ImageCache.hpp"
+#include "core/ChannelManager.hpp"
 
 #if defined(__APPLE__) || defined(__linux__) || defined(_WIN32)
 #include "borealis/platforms/desktop/desktop_platform.hpp"
@@ -501,6 +504,15 @@ void SettingsActivity::onContentAvailable() {
                               ImageHelper::setRequestThreads(threadOption.rawOptionList[data]);
                           });
 
+    // Spazio per i loghi su disco: ridurlo elimina subito i meno usati
+    auto diskCacheOption = conf.getOptionData(SettingItem::IMAGE_DISK_CACHE);
+    selectorImageDiskCache->init("tsvitch/setting/app/image/disk_cache"_i18n, diskCacheOption.optionList,
+                                 conf.getIntOptionIndex(SettingItem::IMAGE_DISK_CACHE), [diskCacheOption](int data) {
+                                     ProgramConfig::instance().setSettingItem(SettingItem::IMAGE_DISK_CACHE,
+                                                                              diskCacheOption.rawOptionList[data]);
+                                     ImageCache::setMaxSize(diskCacheOption.rawOptionList[data]);
+                                 });
+
     selectorInmemory->init("tsvitch/setting/app/playback/in_memory_cache"_i18n,
 #ifdef __PSV__
                            {"0MB (" + "hints/off"_i18n + ")", "1MB", "5MB", "10MB"},
@@ -523,10 +535,29 @@ void SettingsActivity::onContentAvailable() {
                           conf.getIntOptionIndex(SettingItem::IPTV_MODE), [this, iptvModeOption](int data) {
                               ProgramConfig::instance().setSettingItem(SettingItem::IPTV_MODE,
                                                                        iptvModeOption.rawOptionList[data]);
+                              ChannelManager::updateSettings();
                               this->updateIPTVSectionVisibility();
                               OnIPTVModeChanged.fire(); // Notifica il cambio modalità IPTV
                           });
 
+    // Età massima (in giorni) della cache canali mostrata all'avvio
+    auto cacheMaxAgeOption = conf.getOptionData(SettingItem::CHANNEL_CACHE_MAX_AGE);
+    selectorCacheMaxAge->init("Channel Cache Expiry (days)", cacheMaxAgeOption.optionList,
+                              conf.getIntOptionIndex(SettingItem::CHANNEL_CACHE_MAX_AGE), [cacheMaxAgeOption](int data) {
+                                  ProgramConfig::instance().setSettingItem(SettingItem::CHANNEL_CACHE_MAX_AGE,
+                                                                           cacheMaxAgeOption.rawOptionList[data]);
+                                  ChannelManager::updateSettings();
+                              });
+
+    // Ordinamento dei canali nei gruppi: già calcolato, la griglia cambia subito
+    auto channelOrderOption = conf.getOptionData(SettingItem::CHANNEL_ORDER);
+    selectorChannelOrder->init("Channel Order", channelOrderOption.optionList,
+                               conf.getIntOptionIndex(SettingItem::CHANNEL_ORDER), [channelOrderOption](int data) {
+                                   ProgramConfig::instance().setSettingItem(SettingItem::CHANNEL_ORDER,
+                                                                            channelOrderOption.rawOptionList[data]);
+                                   OnChannelOrderChanged.fire();
+                               });
+
     // Inizializza i controlli M3U8
     auto m3u8Url = conf.getSettingItem(SettingItem::M3U8_URL_ITEM, std::string{""});
     btnM3U8Input->init(
@@ -549,6 +580,14 @@ void SettingsActivity::onContentAvailable() {
                                                                            m3u8TimeoutOption.rawOptionList[data]);
                               });
 
+    auto m3u8ThreadsOption = conf.getOptionData(SettingItem::M3U8_PARSE_THREADS);
+    selectorM3U8Threads->init("M3U8 Parse Threads", m3u8ThreadsOption.optionList,
+                              conf.getIntOptionIndex(SettingItem::M3U8_PARSE_THREADS), [m3u8ThreadsOption](int data) {
+                                  ProgramConfig::instance().setSettingItem(SettingItem::M3U8_PARSE_THREADS,
+                                                                           m3u8ThreadsOption.rawOptionList[data]);
+                                  tsvitch::M3uParser::PARSE_THREADS = m3u8ThreadsOption.rawOptionList[data];
+                              });
+
     auto proxyUrl = conf.getSettingItem(SettingItem::PROXY_URL_ITEM, std::string{""});
     btnProxyInput->init(
         "tsvitch/setting/tools/proxy/input"_i18n, proxyUrl,
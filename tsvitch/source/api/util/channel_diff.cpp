@@ -0,0 +1,135 @@
+#include "tsvitch/util/channel_diff.hpp"
+
+#include <string_view>
+#include <unordered_map>
+
+namespace tsvitch {
+
+namespace {
+
+// FNV-1a a 64 bit: l'URL è diviso tra prefisso e resto in punti che possono
+// cambiare da una lista all'altra, quindi l'hash va calcolato sui byte
+inline uint64_t fnv1a(uint64_t hash, std::string_view data) {
+    for (unsigned char c : data) hash = (hash ^ c) * 0x100000001B3ULL;
+    return hash;
+}
+
+inline size_t hashKey(const ChannelStore& store, size_t index) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hash          = fnv1a(hash, store.urlPrefix(index));
+    hash          = fnv1a(hash, store.urlTail(index));
+    hash          = fnv1a(hash, "\n");
+    hash          = fnv1a(hash, store.id(index));
+    return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+// Confronta due stringhe divise in due parti, senza ricomporle
+inline bool sameJoined(std::string_view a1, std::string_view a2, std::string_view b1, std::string_view b2) {
+    if (a1.size() + a2.size() != b1.size() + b2.size()) return false;
+    if (a1.size() > b1.size()) {
+        std::swap(a1, b1);
+        std::swap(a2, b2);
+    }
+    // a1 è il prefisso più corto: b1 = a1 + inizio di a2
+    const size_t split = b1.size() - a1.size();
+    return b1.compare(0, a1.size(), a1) == 0 && a2.compare(0, split, b1, a1.size(), split) == 0 &&
+           a2.compare(split, std::string_view::npos, b2) == 0;
+}
+
+inline bool sameKey(const ChannelStore& a, size_t i, const ChannelStore& b, size_t j) {
+    return a.id(i) == b.id(j) && sameJoined(a.urlPrefix(i), a.urlTail(i), b.urlPrefix(j), b.urlTail(j));
+}
+
+}  // namespace
+
+bool ChannelDiff::sameChannel(const ChannelStore& a, size_t i, const ChannelStore& b, size_t j) {
+    return sameKey(a, i, b, j) && a.title(i) == b.title(j) && a.group(i) == b.group(j) &&
+           sameJoined(a.logoPrefix(i), a.logoTail(i), b.logoPrefix(j), b.logoTail(j)) && a.chno(i) == b.chno(j) &&
+           a.tvgName(i) == b.tvgName(j) && a.tvgRec(i) == b.tvgRec(j) && a.catchup(i) == b.catchup(j) &&
+           a.catchupSource(i) == b.catchupSource(j);
+}
+
+ChannelDiff ChannelDiff::compute(const ChannelStore& oldList, const ChannelStore& newList) {
+    ChannelDiff diff;
+    diff.source.assign(newList.size(), NONE);
+
+    // Tabella a indirizzamento aperto: chiave -> primo indice non ancora abbinato,
+    // i duplicati sono concatenati in nextSame. Nessuna allocazione per canale
+    size_t capacity = 16;
+    while (capacity < oldList.size() * 2) capacity <<= 1;
+    const size_t slotMask = capacity - 1;
+    std::vector<uint32_t> slots(capacity, NONE);
+    std::vector<size_t> hashes(oldList.size());
+    std::vector<uint32_t> nextSame(oldList.size(), NONE);
+
+    auto findSlot = [&](const ChannelStore& store, size_t index, size_t hash) {
+        size_t slot = hash & slotMask;
+        // Uno slot svuotato dagli abbinamenti resta occupato: contiene il primo indice del gruppo di duplicati
+        while (slots[slot] != NONE) {
+            const uint32_t head = slots[slot];
+            if (hashes[head] == hash && sameKey(oldList, head, store, index)) return slot;
+            slot = (slot + 1) & slotMask;
+        }
+        return slot;
+    };
+
+    for (size_t i = oldList.size(); i-- > 0;) {
+        hashes[i]         = hashKey(oldList, i);
+        const size_t slot = findSlot(oldList, i, hashes[i]);
+        if (slots[slot] != NONE) nextSame[i] = slots[slot];
+        slots[slot] = static_cast<uint32_t>(i);
+    }
+    // Prossimo indice da abbinare per ogni slot; quello in slots serve solo a riconoscere la chiave
+    std::vector<uint32_t> pending(slots);
+
+    std::vector<bool> matched(oldList.size(), false);
+    bool inOrder  = true;
+    uint32_t last = 0;
+    for (size_t j = 0; j < newList.size(); ++j) {
+        const size_t slot = findSlot(newList, j, hashKey(newList, j));
+        if (slots[slot] == NONE || pending[slot] == NONE) {
+            diff.added.push_back(j);
+            diff.touchedGroups.insert(newList.group(j));
+            continue;
+        }
+
+        const uint32_t i = pending[slot];
+        pending[slot]    = nextSame[i];
+        matched[i]       = true;
+        diff.source[j]   = i;
+
+        if (!sameChannel(oldList, i, newList, j)) {
+            diff.changed.push_back(j);
+            diff.touchedGroups.insert(oldList.group(i));
+            diff.touchedGroups.insert(newList.group(j));
+        }
+
+        if (i < last) inOrder = false;
+        last = i;
+    }
+
+    for (size_t i = 0; i < oldList.size(); ++i) {
+        if (matched[i]) continue;
+        diff.removed.push_back(i);
+        diff.touchedGroups.insert(oldList.group(i));
+    }
+
+    // Canali spostati: l'ordine relativo va controllato gruppo per gruppo,
+    // solo se quello complessivo non è già rimasto invariato
+    if (!inOrder) {
+        std::unordered_map<uint32_t, uint32_t> lastInGroup;
+        for (size_t j = 0; j < newList.size(); ++j) {
+            const uint32_t i = diff.source[j];
+            if (i == NONE) continue;
+            auto [it, inserted] = lastInGroup.try_emplace(newList.groupId(j), i);
+            if (!inserted) {
+                if (i < it->second) diff.touchedGroups.insert(newList.group(j));
+                it->second = i;
+            }
+        }
+    }
+
+    return diff;
+}
+
+}  // namespace tsvitch
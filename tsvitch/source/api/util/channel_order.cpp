@@ -0,0 +1,141 @@
+#include "tsvitch/util/channel_order.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+#include "tsvitch/util/channel_diff.hpp"
+#include "utils/text_helper.hpp"
+
+namespace tsvitch {
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ULL;
+constexpr uint64_t FNV_PRIME  = 0x100000001B3ULL;
+
+inline uint64_t hashBytes(uint64_t hash, std::string_view text) {
+    for (unsigned char c : text) hash = (hash ^ c) * FNV_PRIME;
+    return hash;
+}
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Chiave di ordinamento: il testo, con ogni numero sostituito da '0', il numero delle sue
+// cifre senza zeri iniziali e le cifre. Confrontando le chiavi byte per byte i numeri si
+// confrontano per valore ("rai 2" prima di "rai 10")
+void appendSortKey(std::string_view text, std::string& out) {
+    for (size_t i = 0; i < text.size();) {
+        if (!isDigit(text[i])) {
+            out.push_back(text[i++]);
+            continue;
+        }
+        while (i < text.size() && text[i] == '0') ++i;
+        size_t end = i;
+        while (end < text.size() && isDigit(text[end])) ++end;
+        out.push_back('0');
+        out.push_back(static_cast<char>(std::min<size_t>(end - i, 255)));
+        out.append(text.substr(i, end - i));
+        i = end;
+    }
+}
+
+// Chiavi di tutti i canali in un'unica arena, con i primi 8 byte di ognuna in un
+// intero: quasi tutti i confronti si decidono lì, senza leggere l'arena
+class SortKeys {
+public:
+    template <typename Field>
+    SortKeys(size_t count, Field&& field) : offsets(count + 1), prefixes(count) {
+        std::string folded;
+        for (size_t i = 0; i < count; ++i) {
+            offsets[i] = static_cast<uint32_t>(arena.size());
+            folded.clear();
+            appendFoldedText(field(i), folded);
+            appendSortKey(folded, arena);
+            uint64_t prefix = 0;
+            for (size_t b = 0; b < 8; ++b) {
+                const size_t pos = offsets[i] + b;
+                prefix           = prefix << 8 | (pos < arena.size() ? static_cast<unsigned char>(arena[pos]) : 0);
+            }
+            prefixes[i] = prefix;
+        }
+        offsets[count] = static_cast<uint32_t>(arena.size());
+    }
+
+    std::string_view key(uint32_t i) const {
+        return std::string_view(arena.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    bool empty(uint32_t i) const { return offsets[i] == offsets[i + 1]; }
+
+    /// Negativo, zero o positivo come il confronto tra le chiavi di a e b
+    int compare(uint32_t a, uint32_t b) const {
+        if (prefixes[a] != prefixes[b]) return prefixes[a] < prefixes[b] ? -1 : 1;
+        return key(a).compare(key(b));
+    }
+
+private:
+    std::string arena;
+    std::vector<uint32_t> offsets;
+    std::vector<uint64_t> prefixes;
+};
+
+}  // namespace
+
+uint64_t watchKey(std::string_view prefix, std::string_view tail) {
+    return hashBytes(hashBytes(FNV_OFFSET, prefix), tail);
+}
+
+uint64_t ChannelOrders::fingerprint(const ChannelStore& store) {
+    uint64_t hash = FNV_OFFSET;
+    for (size_t i = 0; i < store.size(); ++i) {
+        // '\n' non compare nei campi: separa un campo dal successivo
+        hash = (hashBytes(hash, store.title(i)) ^ '\n') * FNV_PRIME;
+        hash = (hashBytes(hash, store.chno(i)) ^ '\n') * FNV_PRIME;
+        hash = (hashBytes(hashBytes(hash, store.urlPrefix(i)), store.urlTail(i)) ^ '\n') * FNV_PRIME;
+    }
+    return hash;
+}
+
+bool ChannelOrders::matches(const ChannelStore& store) const {
+    return byName.size() == store.size() && byNumber.size() == store.size() && addedAt.size() == store.size() &&
+           source == fingerprint(store);
+}
+
+ChannelOrders ChannelOrders::compute(const ChannelStore& store, uint32_t now, const ChannelOrders* previous,
+                                     const ChannelDiff* diff) {
+    ChannelOrders orders;
+    const size_t count = store.size();
+    orders.source      = fingerprint(store);
+
+    // A parità di chiave decide l'indice: l'ordine della playlist, come con un ordinamento stabile
+    const SortKeys titles(count, [&store](size_t i) { return store.title(i); });
+    orders.byName.resize(count);
+    std::iota(orders.byName.begin(), orders.byName.end(), 0u);
+    std::sort(orders.byName.begin(), orders.byName.end(), [&titles](uint32_t a, uint32_t b) {
+        const int order = titles.compare(a, b);
+        return order != 0 ? order < 0 : a < b;
+    });
+
+    std::vector<uint32_t> nameRank(count);
+    for (size_t r = 0; r < count; ++r) nameRank[orders.byName[r]] = static_cast<uint32_t>(r);
+
+    const SortKeys numbers(count, [&store](size_t i) { return store.chno(i); });
+    orders.byNumber.resize(count);
+    std::iota(orders.byNumber.begin(), orders.byNumber.end(), 0u);
+    std::sort(orders.byNumber.begin(), orders.byNumber.end(), [&numbers, &nameRank](uint32_t a, uint32_t b) {
+        if (numbers.empty(a) != numbers.empty(b)) return numbers.empty(b);
+        const int order = numbers.compare(a, b);
+        return order != 0 ? order < 0 : nameRank[a] < nameRank[b];
+    });
+
+    orders.addedAt.assign(count, now);
+    if (previous && diff && diff->source.size() == count) {
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t old = diff->source[i];
+            if (old != ChannelDiff::NONE && old < previous->addedAt.size()) orders.addedAt[i] = previous->addedAt[old];
+        }
+    }
+    return orders;
+}
+
+}  // namespace tsvitch
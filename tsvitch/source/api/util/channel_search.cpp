@@ -0,0 +1,482 @@
+#include "tsvitch/util/channel_search.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "utils/text_helper.hpp"
+
+namespace tsvitch {
+
+namespace {
+
+// Primo elemento di [first, last) non minore di value, cercandolo a passi
+// raddoppiati da first: costa poco quando è vicino, come nelle intersezioni
+inline const uint32_t* gallop(const uint32_t* first, const uint32_t* last, uint32_t value) {
+    size_t step = 1;
+    while (first + step < last && first[step] < value) {
+        first += step;
+        step <<= 1;
+    }
+    return std::lower_bound(first, std::min(first + step + 1, last), value);
+}
+
+// Ogni quanti elementi una ricerca controlla se è stata interrotta
+constexpr size_t CANCEL_CHECK_INTERVAL = 4096;
+
+inline bool stopAt(size_t position, const ChannelSearchIndex::Cancelled& cancelled) {
+    return position % CANCEL_CHECK_INTERVAL == 0 && cancelled && cancelled();
+}
+
+// Lo stato del bitap sta in 64 bit: delle parole più lunghe si confrontano i primi MAX_PATTERN byte
+constexpr size_t MAX_PATTERN  = 63;
+constexpr uint32_t MAX_ERRORS = 2;
+constexpr size_t MAX_WORDS    = 8;
+
+// Errori ammessi per una parola di length byte
+inline uint32_t allowedErrors(size_t length) { return length >= 8 ? 2 : length >= 4 ? 1 : 0; }
+
+// Punteggi di una parola. Quelli esatti partono da GROUP_SCORE, quelli con errori restano sotto
+constexpr uint32_t NUMBER_SCORE        = 1000;
+constexpr uint32_t TITLE_SCORES[3]     = {900, 700, 500};
+constexpr uint32_t GROUP_SCORE         = 300;
+constexpr uint32_t FUZZY_SCORE         = 240;
+constexpr uint32_t FUZZY_ERROR_PENALTY = 100;
+constexpr uint32_t FUZZY_RANK_PENALTY  = 20;
+constexpr uint32_t FUZZY_GROUP_SCORE   = 50;
+
+// Bit della firma di un byte: uno per lettera ASCII e per cifra, gli altri byte condivisi
+inline uint64_t byteBit(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return uint64_t(1) << (c - 'a');
+    if (c >= '0' && c <= '9') return uint64_t(1) << (26 + c - '0');
+    return uint64_t(1) << (36 + c % 28);
+}
+
+inline uint64_t signature(std::string_view text) {
+    uint64_t bits = 0;
+    for (char c : text) bits |= byteBit(static_cast<unsigned char>(c));
+    return bits;
+}
+
+// Parola compilata per il bitap: il bit i di masks[c] è acceso se il byte i della parola è c
+struct Pattern {
+    uint64_t masks[256] = {};
+    uint64_t last       = 0;
+    uint64_t bits       = 0;
+    uint32_t length     = 0;
+    const char* word    = nullptr;
+
+    explicit Pattern(std::string_view text) : bits(signature(text)), word(text.data()) {
+        length = static_cast<uint32_t>(std::min(text.size(), MAX_PATTERN));
+        for (uint32_t i = 0; i < length; ++i) masks[static_cast<unsigned char>(text[i])] |= uint64_t(1) << i;
+        last = uint64_t(1) << (length - 1);
+    }
+};
+
+// 0 se pos è l'inizio di text, 1 se è l'inizio di una parola, altrimenti 2
+inline uint32_t positionRank(std::string_view text, size_t pos) {
+    if (pos == 0) return 0;
+    // Inizio di parola: dopo uno spazio o un segno ASCII; i byte oltre 0x7F sono lettere
+    const unsigned char before = text[pos - 1];
+    return before < 0x80 && !std::isalnum(before) ? 1 : 2;
+}
+
+struct Match {
+    uint32_t errors;
+    uint32_t rank;
+};
+
+// Bitap con K errori (Wu-Manber): R[d] ha il bit i acceso se i primi i + 1 byte della
+// parola finiscono qui con d errori. R[K] contiene tutti gli altri stati: finché non
+// segnala una corrispondenza il ciclo non fa altro che aggiornarli
+template <uint32_t K>
+Match bitap(const Pattern& pattern, std::string_view text) {
+    uint64_t R[K + 1];
+    for (uint32_t d = 0; d <= K; ++d) R[d] = (uint64_t(1) << d) - 1;
+
+    Match best{K + 1, 2};
+    for (size_t j = 0; j < text.size(); ++j) {
+        const uint64_t mask = pattern.masks[static_cast<unsigned char>(text[j])];
+        uint64_t previous   = R[0];
+        R[0]                = ((R[0] << 1) | 1) & mask;
+        for (uint32_t d = 1; d <= K; ++d) {
+            const uint64_t current = R[d];
+            // corrispondenza, byte in più nel testo, byte sostituito, byte mancante
+            R[d]     = (((current << 1) | 1) & mask) | previous | (((previous | R[d - 1]) << 1) | 1);
+            previous = current;
+        }
+        if (!(R[K] & pattern.last)) continue;
+
+        uint32_t d = 0;
+        while (!(R[d] & pattern.last)) ++d;
+        const size_t end    = j + 1;
+        const uint32_t rank = positionRank(text, end > pattern.length ? end - pattern.length : 0);
+        if (d < best.errors || (d == best.errors && rank < best.rank)) best = {d, rank};
+        if (best.errors == 0 && best.rank == 0) break;
+    }
+    return best;
+}
+
+// Occorrenza migliore di pattern in text con al più maxErrors errori: prima meno errori,
+// poi la posizione come in positionRank. errors > maxErrors se non ce n'è
+Match bestMatch(const Pattern& pattern, std::string_view text, uint32_t maxErrors) {
+    if (maxErrors == 1) return bitap<1>(pattern, text);
+    if (maxErrors == 2) return bitap<2>(pattern, text);
+
+    // Senza errori basta cercare la parola, che è più rapido del bitap
+    const std::string_view word(pattern.word, pattern.length);
+    Match best{1, 2};
+    for (size_t pos = text.find(word); pos != std::string_view::npos; pos = text.find(word, pos + 1)) {
+        best.errors = 0;
+        best.rank   = std::min(best.rank, positionRank(text, pos));
+        if (best.rank < 2) break;
+    }
+    return best;
+}
+
+// Valore di un numero di canale di sole cifre (al più nove, spazi ai lati ammessi)
+bool parseNumber(std::string_view text, uint32_t& value) {
+    while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+    while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+    if (text.empty() || text.size() > 9) return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return true;
+}
+
+}  // namespace
+
+// Parola del testo cercato; key e pattern puntano alla chiave della ricerca, che deve restare valida
+struct ChannelSearchIndex::QueryWord {
+    std::string_view key;
+    Pattern pattern;
+    uint32_t maxErrors;
+    uint32_t number = NO_NUMBER;
+    // Errori minimi per ogni gruppo, -1 se il gruppo non corrisponde
+    std::vector<int8_t> groupErrors;
+
+    explicit QueryWord(std::string_view word)
+        : key(word), pattern(word), maxErrors(allowedErrors(word.size())) {
+        if (!parseNumber(word, number)) number = NO_NUMBER;
+    }
+};
+
+uint32_t ChannelSearchIndex::bucket(const char* trigram) {
+    const uint32_t value = static_cast<unsigned char>(trigram[0]) | static_cast<unsigned char>(trigram[1]) << 8 |
+                           static_cast<unsigned char>(trigram[2]) << 16;
+    return (value * 2654435761u) >> (32 - TRIGRAM_BITS);
+}
+
+ChannelSearchIndex::ChannelSearchIndex(std::shared_ptr<const ChannelStore> store) : channels(std::move(store)) {
+    if (!channels) return;
+    const ChannelStore& list = *channels;
+    const size_t count       = list.size();
+
+    // Chiavi dei titoli, una dopo l'altra nell'arena
+    keyOffsets.reserve(count + 1);
+    size_t textBytes = 0;
+    for (size_t i = 0; i < count; ++i) textBytes += list.title(i).size() + 1;
+    keys.reserve(textBytes);
+    for (size_t i = 0; i < count; ++i) {
+        keyOffsets.push_back(static_cast<uint32_t>(keys.size()));
+        appendFoldedText(list.title(i), keys);
+        keys.push_back('\n');
+    }
+    keyOffsets.push_back(static_cast<uint32_t>(keys.size()));
+
+    // Chiavi dei gruppi e canali di ogni gruppo, con un conteggio e una passata di riempimento
+    const auto& groups = list.groupTable();
+    groupKeys.reserve(groups.size());
+    for (const auto& group : groups) groupKeys.push_back(foldText(group));
+    groupOffsets.assign(groups.size() + 1, 0);
+    for (size_t i = 0; i < count; ++i) ++groupOffsets[list.groupId(i) + 1];
+    for (size_t g = 0; g < groups.size(); ++g) groupOffsets[g + 1] += groupOffsets[g];
+    groupChannels.resize(count);
+    {
+        std::vector<uint32_t> cursor(groupOffsets.begin(), groupOffsets.end() - 1);
+        for (size_t i = 0; i < count; ++i) groupChannels[cursor[list.groupId(i)]++] = static_cast<uint32_t>(i);
+    }
+
+    numbers.resize(count);
+    signatures.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!parseNumber(list.chno(i), numbers[i])) numbers[i] = NO_NUMBER;
+        signatures[i] = signature(titleKey(i));
+    }
+
+    // Liste dei trigrammi: prima le lunghezze, poi i canali. lastChannel evita di
+    // aggiungere più volte lo stesso canale a una lista
+    std::vector<uint32_t> lastChannel(TRIGRAM_BUCKETS, ChannelStore::NONE);
+    postingOffsets.assign(TRIGRAM_BUCKETS + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const auto key = titleKey(i);
+        for (size_t pos = 0; pos + 3 <= key.size(); ++pos) {
+            const uint32_t b = bucket(key.data() + pos);
+            if (lastChannel[b] == i) continue;
+            lastChannel[b] = static_cast<uint32_t>(i);
+            ++postingOffsets[b + 1];
+        }
+    }
+    for (size_t b = 0; b < TRIGRAM_BUCKETS; ++b) postingOffsets[b + 1] += postingOffsets[b];
+
+    postings.resize(postingOffsets.back());
+    std::fill(lastChannel.begin(), lastChannel.end(), ChannelStore::NONE);
+    std::vector<uint32_t> cursor(postingOffsets.begin(), postingOffsets.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        const auto key = titleKey(i);
+        for (size_t pos = 0; pos + 3 <= key.size(); ++pos) {
+            const uint32_t b = bucket(key.data() + pos);
+            if (lastChannel[b] == i) continue;
+            lastChannel[b]        = static_cast<uint32_t>(i);
+            postings[cursor[b]++] = static_cast<uint32_t>(i);
+        }
+    }
+}
+
+std::vector<uint32_t> ChannelSearchIndex::findTitles(std::string_view key, const Cancelled& cancelled) const {
+    std::vector<uint32_t> found;
+
+    // Troppo corta per i trigrammi: si cerca direttamente nell'arena, ripartendo
+    // ogni volta dal titolo successivo a quello trovato
+    if (key.size() < 3) {
+        const std::string_view arena(keys);
+        size_t index = 0;
+        for (size_t pos = arena.find(key); pos != std::string_view::npos; pos = arena.find(key, keyOffsets[index + 1])) {
+            while (keyOffsets[index + 1] <= pos) ++index;
+            found.push_back(static_cast<uint32_t>(index));
+            if (stopAt(found.size(), cancelled)) return {};
+        }
+        return found;
+    }
+
+    // Liste dei trigrammi distinti del testo, dalla più corta
+    std::vector<std::pair<const uint32_t*, const uint32_t*>> lists;
+    std::vector<uint32_t> seen;
+    for (size_t pos = 0; pos + 3 <= key.size(); ++pos) {
+        const uint32_t b = bucket(key.data() + pos);
+        if (std::find(seen.begin(), seen.end(), b) != seen.end()) continue;
+        seen.push_back(b);
+        if (postingOffsets[b] == postingOffsets[b + 1]) return found;
+        lists.emplace_back(postings.data() + postingOffsets[b], postings.data() + postingOffsets[b + 1]);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const auto& a, const auto& b) { return a.second - a.first < b.second - b.first; });
+
+    found.assign(lists.front().first, lists.front().second);
+    for (size_t l = 1; l < lists.size() && !found.empty(); ++l) {
+        if (cancelled && cancelled()) return {};
+        const uint32_t* cursor = lists[l].first;
+        const uint32_t* end    = lists[l].second;
+        size_t kept            = 0;
+        for (uint32_t candidate : found) {
+            cursor = gallop(cursor, end, candidate);
+            if (cursor == end) break;
+            if (*cursor == candidate) found[kept++] = candidate;
+        }
+        found.resize(kept);
+    }
+
+    // Tutti i trigrammi presenti non bastano: conta l'ordine, e le collisioni dell'hash
+    size_t kept = 0;
+    for (size_t c = 0; c < found.size(); ++c) {
+        if (stopAt(c + 1, cancelled)) return {};
+        if (titleKey(found[c]).find(key) != std::string_view::npos) found[kept++] = found[c];
+    }
+    found.resize(kept);
+    return found;
+}
+
+std::vector<uint32_t> ChannelSearchIndex::findExact(const QueryWord& word, const Cancelled& cancelled) const {
+    std::vector<uint32_t> titles = findTitles(word.key, cancelled);
+    if (cancelled && cancelled()) return {};
+
+    size_t extra = 0;
+    for (size_t g = 0; g < groupKeys.size(); ++g)
+        if (word.groupErrors[g] == 0) extra += groupOffsets[g + 1] - groupOffsets[g];
+    if (word.number == NO_NUMBER && extra == 0) return titles;
+
+    // Titoli, gruppi e numeri in un'unica lista ordinata senza doppioni
+    std::vector<uint8_t> hits(channels->size(), 0);
+    for (uint32_t index : titles) hits[index] = 1;
+    for (size_t g = 0; g < groupKeys.size(); ++g) {
+        if (word.groupErrors[g] != 0) continue;
+        for (uint32_t i = groupOffsets[g]; i < groupOffsets[g + 1]; ++i) hits[groupChannels[i]] = 1;
+    }
+    if (word.number != NO_NUMBER)
+        for (size_t i = 0; i < numbers.size(); ++i) hits[i] |= numbers[i] == word.number;
+
+    titles.clear();
+    for (size_t i = 0; i < hits.size(); ++i)
+        if (hits[i]) titles.push_back(static_cast<uint32_t>(i));
+    return titles;
+}
+
+uint32_t ChannelSearchIndex::wordScore(const QueryWord& word, size_t index, uint32_t maxErrors) const {
+    if (word.number != NO_NUMBER && numbers[index] == word.number) return NUMBER_SCORE;
+
+    // Ogni byte distinto della parola assente dal titolo costa almeno un errore
+    const int8_t group = word.groupErrors[channels->groupId(index)];
+    if (group < 0 && std::bitset<64>(word.pattern.bits & ~signatures[index]).count() > maxErrors)
+        return 0;
+
+    const Match title = bestMatch(word.pattern, titleKey(index), maxErrors);
+    if (title.errors == 0) return TITLE_SCORES[title.rank];
+
+    if (group == 0) return GROUP_SCORE;
+    if (title.errors <= maxErrors)
+        return FUZZY_SCORE - (title.errors - 1) * FUZZY_ERROR_PENALTY - title.rank * FUZZY_RANK_PENALTY;
+    if (group > 0 && static_cast<uint32_t>(group) <= maxErrors) return FUZZY_GROUP_SCORE;
+    return 0;
+}
+
+std::vector<uint32_t> ChannelSearchIndex::find(std::string_view text, size_t limit, const Cancelled& cancelled) const {
+    if (!channels || limit == 0) return {};
+    const std::string key = foldText(text);
+
+    // Le chiavi hanno già gli spazi compressi: le parole sono separate da uno spazio solo
+    std::vector<QueryWord> words;
+    for (size_t start = 0; start < key.size() && words.size() < MAX_WORDS;) {
+        size_t end = key.find(' ', start);
+        if (end == std::string::npos) end = key.size();
+        words.emplace_back(std::string_view(key).substr(start, end - start));
+        start = end + 1;
+    }
+    if (words.empty()) return {};
+
+    bool fuzzy = false;
+    for (auto& word : words) {
+        word.groupErrors.resize(groupKeys.size());
+        for (size_t g = 0; g < groupKeys.size(); ++g) {
+            const Match match   = bestMatch(word.pattern, groupKeys[g], word.maxErrors);
+            word.groupErrors[g] = match.errors <= word.maxErrors ? static_cast<int8_t>(match.errors) : -1;
+        }
+        fuzzy |= word.maxErrors > 0;
+    }
+
+    // Canali che contengono tutte le parole senza errori; strict solo quelle che non ne ammettono
+    std::vector<uint32_t> exact, strict;
+    bool anyStrict = false;
+    for (size_t w = 0; w < words.size(); ++w) {
+        std::vector<uint32_t> found = findExact(words[w], cancelled);
+        if (cancelled && cancelled()) return {};
+        if (words[w].maxErrors == 0) {
+            if (!anyStrict) strict = found;
+            else {
+                std::vector<uint32_t> both;
+                std::set_intersection(strict.begin(), strict.end(), found.begin(), found.end(), std::back_inserter(both));
+                strict.swap(both);
+            }
+            anyStrict = true;
+        }
+        if (w == 0) exact = std::move(found);
+        else {
+            std::vector<uint32_t> both;
+            std::set_intersection(exact.begin(), exact.end(), found.begin(), found.end(), std::back_inserter(both));
+            exact.swap(both);
+        }
+    }
+
+    // I migliori limit punteggi in un heap con in cima il peggiore: non si ordinano mai tutte
+    // le corrispondenze. Il punteggio conta prima le parole trovate senza errori, poi la
+    // somma dei punteggi e la brevità del titolo; il resto della chiave è l'ordine dello store
+    std::vector<uint64_t> heap;
+    heap.reserve(std::min(limit, exact.size() + 1));
+    auto offer = [&](uint32_t index, uint32_t maxErrors) {
+        uint32_t exactWords = 0, sum = 0;
+        for (const auto& word : words) {
+            const uint32_t score = wordScore(word, index, std::min(maxErrors, word.maxErrors));
+            if (score == 0) return;
+            sum += score;
+            exactWords += score >= GROUP_SCORE;
+        }
+        const uint64_t shortness = 63 - std::min<size_t>(titleKey(index).size(), 63);
+        const uint64_t rank      = (uint64_t(exactWords) << 24 | uint64_t(sum) << 6 | shortness) << 32 | (UINT32_MAX - index);
+        if (heap.size() < limit) {
+            heap.push_back(rank);
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        } else if (rank > heap.front()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            heap.back() = rank;
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        }
+    };
+
+    for (size_t c = 0; c < exact.size(); ++c) {
+        if (stopAt(c + 1, cancelled)) return {};
+        offer(exact[c], 0);
+    }
+
+    // Con errori solo se le corrispondenze esatte non bastano: tra i canali che contengono
+    // le parole corte, o tra tutti, saltando quelli già valutati
+    if (fuzzy && exact.size() < limit) {
+        size_t next = 0;
+        auto tryFuzzy = [&](uint32_t index) {
+            while (next < exact.size() && exact[next] < index) ++next;
+            if (next < exact.size() && exact[next] == index) return;
+            offer(index, MAX_ERRORS);
+        };
+        if (anyStrict) {
+            for (size_t c = 0; c < strict.size(); ++c) {
+                if (stopAt(c + 1, cancelled)) return {};
+                tryFuzzy(strict[c]);
+            }
+        } else {
+            for (uint32_t i = 0; i < channels->size(); ++i) {
+                if (stopAt(i + 1, cancelled)) return {};
+                tryFuzzy(i);
+            }
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), std::greater<>());
+    std::vector<uint32_t> ranked(heap.size());
+    for (size_t r = 0; r < heap.size(); ++r) ranked[r] = UINT32_MAX - static_cast<uint32_t>(heap[r]);
+    return ranked;
+}
+
+std::vector<uint32_t> ChannelSearchIndex::scan(const ChannelStore& store, std::string_view text, const Cancelled& cancelled) {
+    const std::string key = foldText(text);
+    if (key.empty()) return {};
+
+    // I nomi dei gruppi sono condivisi: basta confrontarli una volta sola. Gruppi e titoli
+    // vengono convertiti nello stesso buffer, senza un'allocazione per ogni testo
+    const auto& groups = store.groupTable();
+    std::vector<bool> groupMatches(groups.size());
+    std::string folded;
+    for (size_t id = 0; id < groups.size(); ++id) {
+        folded.clear();
+        appendFoldedText(groups[id], folded);
+        groupMatches[id] = folded.find(key) != std::string::npos;
+    }
+
+    std::vector<uint32_t> found;
+    for (size_t i = 0; i < store.size(); ++i) {
+        if (stopAt(i + 1, cancelled)) return {};
+        if (groupMatches[store.groupId(i)]) {
+            found.push_back(static_cast<uint32_t>(i));
+            continue;
+        }
+        folded.clear();
+        appendFoldedText(store.title(i), folded);
+        if (folded.find(key) != std::string::npos) found.push_back(static_cast<uint32_t>(i));
+    }
+    return found;
+}
+
+size_t ChannelSearchIndex::memoryUsage() const {
+    size_t bytes = keys.capacity() + (keyOffsets.capacity() + groupOffsets.capacity() + groupChannels.capacity() +
+                                      numbers.capacity() + postingOffsets.capacity() + postings.capacity()) *
+                                         sizeof(uint32_t) +
+                   signatures.capacity() * sizeof(uint64_t);
+    for (const auto& key : groupKeys) bytes += key.capacity();
+    return bytes;
+}
+
+}  // namespace tsvitch
@@ -0,0 +1,375 @@
+#include "tsvitch/util/channel_store.hpp"
+#include "tsvitch/util/mapped_file.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace tsvitch {
+
+namespace {
+
+constexpr size_t ALIGNMENT = 8;
+
+inline size_t padding(size_t size) { return (ALIGNMENT - size % ALIGNMENT) % ALIGNMENT; }
+
+inline uint64_t aligned(uint64_t size) { return size + padding(static_cast<size_t>(size % ALIGNMENT)); }
+
+}  // namespace
+
+ChannelStore ChannelStore::fromList(const LiveM3u8ListResult& list) {
+    ChannelStore store;
+    store.reserve(list.size());
+    for (const auto& channel : list) store.push_back(channel);
+    return store;
+}
+
+void ChannelStore::reserve(size_t channels) {
+    detach();
+    forEachSpanColumn([channels](Column<Span>& column) { column.reserve(channels); });
+    groupIds.reserve(channels);
+    urlPrefixes.reserve(channels);
+    logoPrefixes.reserve(channels);
+    // Titolo, parte finale dell'URL e poco altro: una stima per evitare la maggior parte delle riallocazioni
+    arena.reserve(channels * 48);
+}
+
+void ChannelStore::detach() {
+    if (!file) return;
+    forEachSpanColumn([](Column<Span>& column) { column.detach(); });
+    groupIds.detach();
+    urlPrefixes.detach();
+    logoPrefixes.detach();
+    arena.detach();
+    file.reset();
+}
+
+ChannelStore::Span ChannelStore::store(std::string_view value) {
+    // Le stringhe vuote non occupano l'arena
+    if (value.empty()) return {0, 0};
+    Span span{static_cast<uint32_t>(arena.size()), static_cast<uint32_t>(value.size())};
+    arena.append(value.data(), value.size());
+    return span;
+}
+
+size_t ChannelStore::InternTable::findSlot(std::string_view value) const {
+    const size_t mask = slots.size() - 1;
+    size_t slot       = std::hash<std::string_view>{}(value) & mask;
+    while (slots[slot] != NONE && values[slots[slot]] != value) slot = (slot + 1) & mask;
+    return slot;
+}
+
+bool ChannelStore::InternTable::contains(std::string_view value) const {
+    return !slots.empty() && slots[findSlot(value)] != NONE;
+}
+
+void ChannelStore::InternTable::rehash(size_t count) {
+    // Riempimento massimo 1/2, la tabella raddoppia ricalcolando le posizioni
+    size_t capacity = std::max<size_t>(slots.size(), 64);
+    while (count * 2 > capacity) capacity *= 2;
+    slots.assign(capacity, NONE);
+    for (uint32_t i = 0; i < values.size(); ++i) slots[findSlot(values[i])] = i;
+}
+
+uint32_t ChannelStore::InternTable::intern(std::string_view value) {
+    if ((values.size() + 1) * 2 > slots.size()) rehash(values.size() + 1);
+    const size_t slot = findSlot(value);
+    if (slots[slot] == NONE) {
+        slots[slot] = static_cast<uint32_t>(values.size());
+        values.emplace_back(value);
+    }
+    return slots[slot];
+}
+
+uint32_t ChannelStore::internPrefix(std::string_view value, std::string_view& tail) {
+    // Cartella: tutto fino all'ultima '/' prima dell'eventuale query
+    size_t query = value.find('?');
+    size_t slash = value.rfind('/', query == std::string_view::npos ? std::string_view::npos : query);
+    if (slash == std::string_view::npos) {
+        tail = value;
+        return prefixes.intern({});
+    }
+
+    std::string_view prefix = value.substr(0, slash + 1);
+    if (prefixes.values.size() >= MAX_PREFIXES && !prefixes.contains(prefix)) {
+        // Troppi prefissi distinti: solo schema e host
+        size_t scheme = value.find("://");
+        size_t host   = value.find('/', scheme == std::string_view::npos ? 0 : scheme + 3);
+        prefix        = value.substr(0, host == std::string_view::npos ? 0 : host + 1);
+    }
+    tail = value.substr(prefix.size());
+    return prefixes.intern(prefix);
+}
+
+void ChannelStore::push_back(const LiveM3u8& channel) {
+    detach();
+    ids.push_back(store(channel.id));
+    chnos.push_back(store(channel.chno));
+    titles.push_back(store(channel.title));
+    tvgNames.push_back(store(channel.tvgName));
+    tvgRecs.push_back(store(channel.tvgRec));
+    catchups.push_back(store(channel.catchup));
+    catchupSources.push_back(store(channel.catchupSource));
+    groupIds.push_back(groups.intern(channel.groupTitle));
+
+    std::string_view tail;
+    urlPrefixes.push_back(internPrefix(channel.url, tail));
+    urlTails.push_back(store(tail));
+    logoPrefixes.push_back(internPrefix(channel.logo, tail));
+    logoTails.push_back(store(tail));
+}
+
+void ChannelStore::push_back(const ChannelStore& other, size_t index) {
+    detach();
+    ids.push_back(store(other.id(index)));
+    chnos.push_back(store(other.chno(index)));
+    titles.push_back(store(other.title(index)));
+    tvgNames.push_back(store(other.tvgName(index)));
+    tvgRecs.push_back(store(other.tvgRec(index)));
+    catchups.push_back(store(other.catchup(index)));
+    catchupSources.push_back(store(other.catchupSource(index)));
+    groupIds.push_back(groups.intern(other.group(index)));
+    // I prefissi di other sono già stati scelti: si riusano così come sono
+    urlPrefixes.push_back(prefixes.intern(other.urlPrefix(index)));
+    urlTails.push_back(store(other.urlTail(index)));
+    logoPrefixes.push_back(prefixes.intern(other.logoPrefix(index)));
+    logoTails.push_back(store(other.logoTail(index)));
+}
+
+void ChannelStore::append(const ChannelStore& other) {
+    for (size_t i = 0; i < other.size(); ++i) push_back(other, i);
+}
+
+void ChannelStore::sortByGroup() {
+    // Gli id dei gruppi seguono l'ordine di prima comparsa: basta un ordinamento per conteggio
+    const size_t groupCount = groups.values.size();
+    std::vector<uint32_t> start(groupCount + 1, 0);
+    bool contiguous = true;
+    for (size_t i = 0; i < size(); ++i) {
+        const uint32_t group = groupIds[i];
+        if (i > 0 && group != groupIds[i - 1] && start[group + 1] > 0) contiguous = false;
+        ++start[group + 1];
+    }
+    if (contiguous) return;
+
+    for (size_t g = 0; g < groupCount; ++g) start[g + 1] += start[g];
+    std::vector<uint32_t> order(size());
+    for (size_t i = 0; i < size(); ++i) order[start[groupIds[i]]++] = static_cast<uint32_t>(i);
+
+    ChannelStore sorted;
+    sorted.reserve(size());
+    for (uint32_t index : order) sorted.push_back(*this, index);
+    *this = std::move(sorted);
+}
+
+LiveM3u8 ChannelStore::at(size_t index) const {
+    LiveM3u8 channel;
+    channel.id            = id(index);
+    channel.chno          = chno(index);
+    channel.title         = title(index);
+    channel.logo          = logo(index);
+    channel.groupTitle    = group(index);
+    channel.url           = url(index);
+    channel.tvgName       = tvgName(index);
+    channel.tvgRec        = tvgRec(index);
+    channel.catchup       = catchup(index);
+    channel.catchupSource = catchupSource(index);
+    return channel;
+}
+
+bool ChannelStore::urlEquals(size_t index, std::string_view value) const {
+    std::string_view prefix = urlPrefix(index);
+    std::string_view tail   = urlTail(index);
+    return value.size() == prefix.size() + tail.size() && value.compare(0, prefix.size(), prefix) == 0 &&
+           value.compare(prefix.size(), tail.size(), tail) == 0;
+}
+
+std::string ChannelStore::join(std::string_view prefix, std::string_view tail) {
+    std::string result;
+    result.reserve(prefix.size() + tail.size());
+    result.append(prefix).append(tail);
+    return result;
+}
+
+size_t ChannelStore::memoryUsage() const {
+    size_t bytes = arena.capacity() + (groupIds.capacity() + urlPrefixes.capacity() + logoPrefixes.capacity()) * sizeof(uint32_t);
+    forEachSpanColumn([&bytes](const Column<Span>& column) { bytes += column.capacity() * sizeof(Span); });
+    for (const auto* table : {&groups, &prefixes}) {
+        bytes += table->slots.capacity() * sizeof(uint32_t);
+        for (const auto& value : table->values) bytes += sizeof(std::string) + value.capacity();
+    }
+    return bytes;
+}
+
+void ChannelStore::serialize(const Sink& sink) const {
+    static const char zeros[ALIGNMENT] = {};
+    auto write = [&sink](const void* data, size_t size) {
+        if (size > 0) sink(data, size);
+        if (padding(size) > 0) sink(zeros, padding(size));
+    };
+
+    // Tabelle: intervalli in un blocco di testo dedicato, prima i gruppi e poi i prefissi
+    std::vector<Span> tables;
+    std::string tableText;
+    for (const auto* table : {&groups, &prefixes}) {
+        for (const auto& value : table->values) {
+            tables.push_back({static_cast<uint32_t>(tableText.size()), static_cast<uint32_t>(value.size())});
+            tableText += value;
+        }
+    }
+
+    ImageHeader header{};
+    header.channels   = static_cast<uint32_t>(size());
+    header.groups     = static_cast<uint32_t>(groups.values.size());
+    header.prefixes   = static_cast<uint32_t>(prefixes.values.size());
+    header.tableBytes = tableText.size();
+    header.arenaBytes = arena.size();
+    write(&header, sizeof(header));
+    write(tables.data(), tables.size() * sizeof(Span));
+    write(tableText.data(), tableText.size());
+
+    forEachSpanColumn([&](const Column<Span>& column) { write(column.data(), column.size() * sizeof(Span)); });
+    for (const auto* column : {&groupIds, &urlPrefixes, &logoPrefixes})
+        write(column->data(), column->size() * sizeof(uint32_t));
+    write(arena.data(), arena.size());
+}
+
+ChannelStore::ImageLayout::ImageLayout(const ImageHeader& header) {
+    spanColumnBytes = aligned(uint64_t(header.channels) * sizeof(Span));
+    idColumnBytes   = aligned(uint64_t(header.channels) * sizeof(uint32_t));
+    tables          = aligned(sizeof(ImageHeader));
+    tableText       = tables + aligned((uint64_t(header.groups) + header.prefixes) * sizeof(Span));
+    spanColumns     = tableText + aligned(header.tableBytes);
+    idColumns       = spanColumns + 9 * spanColumnBytes;
+    arena           = idColumns + 3 * idColumnBytes;
+}
+
+bool ChannelStore::deserialize(std::shared_ptr<const MappedFile> file, size_t offset, size_t size, ChannelStore& out) {
+    if (!file || offset % ALIGNMENT != 0 || offset > file->size() || size > file->size() - offset) return false;
+    const char* base   = file->data() + offset;
+    size_t position    = 0;
+    // Restituisce il blocco successivo di bytes byte, o nullptr se l'immagine è troppo corta
+    auto next = [&](uint64_t bytes) -> const char* {
+        if (bytes > size - position) return nullptr;
+        const char* block = base + position;
+        position += static_cast<size_t>(bytes);
+        position = std::min(size, position + padding(position));
+        return block;
+    };
+
+    const auto* header = reinterpret_cast<const ImageHeader*>(next(sizeof(ImageHeader)));
+    if (!header) return false;
+    const size_t channels = header->channels;
+    const size_t entries  = size_t(header->groups) + header->prefixes;
+    const auto* tables    = reinterpret_cast<const Span*>(next(uint64_t(entries) * sizeof(Span)));
+    const char* tableText = next(header->tableBytes);
+    if (!tables || !tableText) return false;
+
+    ChannelStore result;
+    for (size_t i = 0; i < entries; ++i) {
+        if (tables[i].offset > header->tableBytes || tables[i].length > header->tableBytes - tables[i].offset) return false;
+        auto& table = i < header->groups ? result.groups : result.prefixes;
+        table.values.emplace_back(tableText + tables[i].offset, tables[i].length);
+    }
+    // Le posizioni non sono nell'immagine: senza, contains() non troverebbe nessun valore
+    result.groups.rehash(result.groups.values.size());
+    result.prefixes.rehash(result.prefixes.values.size());
+    // Gruppi e prefissi sono sempre presenti almeno una volta se ci sono canali
+    if (channels > 0 && (header->groups == 0 || header->prefixes == 0)) return false;
+
+    bool valid = true;
+    result.forEachSpanColumn([&](Column<Span>& column) {
+        const auto* values = reinterpret_cast<const Span*>(next(uint64_t(channels) * sizeof(Span)));
+        if (!values) {
+            valid = false;
+            return;
+        }
+        for (size_t i = 0; i < channels && valid; ++i)
+            valid = values[i].offset <= header->arenaBytes && values[i].length <= header->arenaBytes - values[i].offset;
+        column.map(values, channels);
+    });
+    if (!valid) return false;
+
+    const uint32_t limits[] = {header->groups, header->prefixes, header->prefixes};
+    Column<uint32_t>* ids[] = {&result.groupIds, &result.urlPrefixes, &result.logoPrefixes};
+    for (size_t c = 0; c < 3; ++c) {
+        const auto* values = reinterpret_cast<const uint32_t*>(next(uint64_t(channels) * sizeof(uint32_t)));
+        if (!values) return false;
+        for (size_t i = 0; i < channels; ++i)
+            if (values[i] >= limits[c]) return false;
+        ids[c]->map(values, channels);
+    }
+
+    const char* arena = next(header->arenaBytes);
+    if (!arena) return false;
+    result.arena.map(arena, static_cast<size_t>(header->arenaBytes));
+    result.file  = std::move(file);
+    out          = std::move(result);
+    return true;
+}
+
+bool ChannelStore::readRange(const Reader& read, size_t first, size_t count, ChannelStore& out) {
+    ImageHeader header{};
+    if (!read(0, &header, sizeof(header))) return false;
+    if (first > header.channels || count > header.channels - first) return false;
+    if (count == 0) return true;
+    const ImageLayout layout(header);
+
+    // Tabelle complete (poche), colonne e arena solo per l'intervallo richiesto
+    const size_t entries = size_t(header.groups) + header.prefixes;
+    std::vector<Span> tables(entries);
+    std::string tableText(static_cast<size_t>(header.tableBytes), '\0');
+    if (!read(layout.tables, tables.data(), entries * sizeof(Span)) ||
+        !read(layout.tableText, tableText.data(), tableText.size()))
+        return false;
+
+    ChannelStore slice;
+    for (size_t i = 0; i < entries; ++i) {
+        if (tables[i].offset > header.tableBytes || tables[i].length > header.tableBytes - tables[i].offset) return false;
+        auto& table = i < header.groups ? slice.groups : slice.prefixes;
+        table.values.emplace_back(tableText, tables[i].offset, tables[i].length);
+    }
+    slice.groups.rehash(slice.groups.values.size());
+    slice.prefixes.rehash(slice.prefixes.values.size());
+
+    std::vector<Span> spans[9];
+    uint64_t arenaBegin = header.arenaBytes, arenaEnd = 0;
+    for (size_t c = 0; c < 9; ++c) {
+        spans[c].resize(count);
+        if (!read(layout.spanColumn(c) + first * sizeof(Span), spans[c].data(), count * sizeof(Span))) return false;
+        for (const Span& span : spans[c]) {
+            if (span.offset > header.arenaBytes || span.length > header.arenaBytes - span.offset) return false;
+            if (span.length == 0) continue;
+            arenaBegin = std::min<uint64_t>(arenaBegin, span.offset);
+            arenaEnd   = std::max<uint64_t>(arenaEnd, uint64_t(span.offset) + span.length);
+        }
+    }
+    if (arenaEnd == 0) arenaBegin = 0;
+
+    const uint32_t limits[] = {header.groups, header.prefixes, header.prefixes};
+    Column<uint32_t>* ids[] = {&slice.groupIds, &slice.urlPrefixes, &slice.logoPrefixes};
+    for (size_t c = 0; c < 3; ++c) {
+        std::vector<uint32_t> values(count);
+        if (!read(layout.idColumn(c) + first * sizeof(uint32_t), values.data(), count * sizeof(uint32_t))) return false;
+        for (uint32_t value : values)
+            if (value >= limits[c]) return false;
+        ids[c]->append(values.data(), count);
+    }
+
+    // Arena del solo intervallo: gli offset vengono spostati all'inizio del blocco letto
+    std::string arena(static_cast<size_t>(arenaEnd - arenaBegin), '\0');
+    if (!read(layout.arena + arenaBegin, arena.data(), arena.size())) return false;
+    slice.arena.append(arena.data(), arena.size());
+    size_t c = 0;
+    slice.forEachSpanColumn([&](Column<Span>& column) {
+        for (Span& span : spans[c]) span.offset = span.length == 0 ? 0 : span.offset - static_cast<uint32_t>(arenaBegin);
+        column.append(spans[c].data(), count);
+        ++c;
+    });
+
+    // Nuove tabelle con i soli gruppi e prefissi usati
+    out.reserve(out.size() + count);
+    out.append(slice);
+    return true;
+}
+
+}  // namespace tsvitch
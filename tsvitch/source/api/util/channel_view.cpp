@@ -0,0 +1,115 @@
+#include "tsvitch/util/channel_view.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+namespace tsvitch {
+
+const std::string& ChannelGroups::displayName(const std::string& groupTitle) {
+    static const std::string uncategorized = "Uncategorized";
+    return groupTitle.empty() ? uncategorized : groupTitle;
+}
+
+ChannelGroups::ChannelGroups(std::shared_ptr<const ChannelStore> store) : ChannelGroups(std::move(store), nullptr, {}) {}
+
+ChannelGroups::ChannelGroups(std::shared_ptr<const ChannelStore> store, std::shared_ptr<const ChannelOrders> orders,
+                             const WatchCounts& watched)
+    : channels(std::move(store)), sortKeys(std::move(orders)) {
+    if (!channels) return;
+    const auto& table = channels->groupTable();
+
+    // "" e "Uncategorized" finiscono nello stesso gruppo: più id possono avere lo stesso nome
+    std::unordered_map<std::string, uint32_t> slotOf;
+    std::vector<uint32_t> slots(table.size());
+    std::vector<const std::string*> names;
+    for (size_t id = 0; id < table.size(); ++id) {
+        auto [it, inserted] = slotOf.try_emplace(displayName(table[id]), static_cast<uint32_t>(names.size()));
+        if (inserted) names.push_back(&it->first);
+        slots[id] = it->second;
+    }
+    std::vector<uint32_t> counts(names.size(), 0);
+    for (size_t i = 0; i < channels->size(); ++i) ++counts[slots[channels->groupId(i)]];
+
+    // Gruppi della tabella senza canali (store parziale) esclusi
+    std::vector<uint32_t> sorted;
+    for (uint32_t slot = 0; slot < names.size(); ++slot)
+        if (counts[slot] > 0) sorted.push_back(slot);
+    std::sort(sorted.begin(), sorted.end(), [&names](uint32_t a, uint32_t b) { return *names[a] < *names[b]; });
+
+    // Gli intervalli seguono l'ordine alfabetico dei gruppi
+    std::vector<uint32_t> next(names.size(), 0);
+    uint32_t start = 0;
+    sortedTitles.reserve(sorted.size());
+    for (uint32_t slot : sorted) {
+        sortedTitles.push_back(*names[slot]);
+        ranges.emplace(*names[slot], std::make_pair(start, counts[slot]));
+        next[slot] = start;
+        start += counts[slot];
+    }
+    tree = std::make_shared<const GroupTree>(sortedTitles);
+
+    // Distribuisce i canali di sequence (tutti, o quelli dello store se nulla) negli
+    // intervalli dei gruppi, conservandone l'ordine
+    const size_t count = channels->size();
+    auto scatter = [&](const std::vector<uint32_t>* sequence) {
+        std::vector<uint32_t> cursor(next);
+        auto permutation = std::make_shared<std::vector<uint32_t>>(count);
+        for (size_t k = 0; k < count; ++k) {
+            const uint32_t i = sequence ? (*sequence)[k] : static_cast<uint32_t>(k);
+            (*permutation)[cursor[slots[channels->groupId(i)]]++] = i;
+        }
+        return permutation;
+    };
+    auto& playlist = orderings[static_cast<size_t>(ChannelOrder::PLAYLIST)];
+    playlist       = scatter(nullptr);
+
+    if (!sortKeys || sortKeys->byName.size() != count || sortKeys->byNumber.size() != count ||
+        sortKeys->addedAt.size() != count)
+        return;
+    orderings[static_cast<size_t>(ChannelOrder::NAME)]   = scatter(&sortKeys->byName);
+    orderings[static_cast<size_t>(ChannelOrder::NUMBER)] = scatter(&sortKeys->byNumber);
+
+    // Prima i canali comparsi più di recente; se sono comparsi tutti insieme è l'ordine della playlist
+    const auto& addedAt = sortKeys->addedAt;
+    if (std::adjacent_find(addedAt.begin(), addedAt.end(), std::not_equal_to<>()) == addedAt.end()) {
+        orderings[static_cast<size_t>(ChannelOrder::RECENTLY_ADDED)] = playlist;
+    } else {
+        std::vector<uint32_t> sequence(count);
+        std::iota(sequence.begin(), sequence.end(), 0u);
+        std::stable_sort(sequence.begin(), sequence.end(),
+                         [&addedAt](uint32_t a, uint32_t b) { return addedAt[a] > addedAt[b]; });
+        orderings[static_cast<size_t>(ChannelOrder::RECENTLY_ADDED)] = scatter(&sequence);
+    }
+
+    // Prima i canali visti, dal più visto, poi gli altri nell'ordine della playlist
+    std::vector<uint32_t> views;
+    std::vector<uint32_t> sequence;
+    if (!watched.empty()) {
+        views.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto it  = watched.find(watchKey(channels->urlPrefix(i), channels->urlTail(i)));
+            views[i] = it != watched.end() ? it->second : 0;
+            if (views[i] > 0) sequence.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    if (sequence.empty()) {
+        orderings[static_cast<size_t>(ChannelOrder::MOST_WATCHED)] = playlist;
+    } else {
+        std::stable_sort(sequence.begin(), sequence.end(), [&views](uint32_t a, uint32_t b) { return views[a] > views[b]; });
+        sequence.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            if (views[i] == 0) sequence.push_back(static_cast<uint32_t>(i));
+        orderings[static_cast<size_t>(ChannelOrder::MOST_WATCHED)] = scatter(&sequence);
+    }
+}
+
+ChannelView ChannelGroups::view(const std::string& title, ChannelOrder order) const {
+    auto it = ranges.find(title);
+    if (it == ranges.end()) return {};
+    const auto& permutation = orderings[static_cast<size_t>(order)];
+    return ChannelView(channels, permutation ? permutation : orderings[static_cast<size_t>(ChannelOrder::PLAYLIST)],
+                       it->second.first, it->second.second);
+}
+
+}  // namespace tsvitch
@@ -0,0 +1,179 @@
+#include "tsvitch/util/group_tree.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace tsvitch {
+
+namespace {
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Nodo in costruzione: il nome è title[start, end) del titolo rep, da cui è nato
+struct Draft {
+    uint32_t rep   = 0;
+    uint32_t start = 0;
+    uint32_t end   = 0;
+    uint32_t group = GroupTree::NONE;
+    std::vector<uint32_t> children;
+    // Cartelle figlie per nome
+    std::unordered_map<std::string_view, uint32_t> folders;
+};
+
+}  // namespace
+
+std::vector<std::string_view> GroupTree::split(std::string_view title) {
+    std::vector<std::string_view> parts;
+    size_t start = 0;
+    auto push    = [&](size_t end) {
+        while (start < end && title[start] == ' ') ++start;
+        while (end > start && title[end - 1] == ' ') --end;
+        if (end > start) parts.push_back(title.substr(start, end - start));
+    };
+    for (size_t i = 0; i < title.size(); ++i) {
+        const char c         = title[i];
+        const bool spaced    = (i > 0 && title[i - 1] == ' ') || (i + 1 < title.size() && title[i + 1] == ' ');
+        const bool clock     = i > 0 && i + 1 < title.size() && isDigit(title[i - 1]) && isDigit(title[i + 1]);
+        const bool separator = c == '|' || (c == ':' && !clock) || (c == '-' && spaced);
+        if (!separator) continue;
+        push(i);
+        start = i + 1;
+    }
+    push(title.size());
+    return parts;
+}
+
+GroupTree::GroupTree(const std::vector<std::string>& titles) {
+    std::vector<Draft> drafts(1);
+    for (uint32_t g = 0; g < titles.size(); ++g) {
+        const std::string& title = titles[g];
+        auto parts               = split(title);
+        if (parts.empty()) parts.push_back(title);
+        auto offset = [&title](std::string_view part) { return static_cast<uint32_t>(part.data() - title.data()); };
+
+        // Una cartella per ogni parte tranne l'ultima, poi il gruppo
+        uint32_t parent = 0;
+        for (size_t p = 0; p + 1 < parts.size(); ++p) {
+            auto it = drafts[parent].folders.find(parts[p]);
+            if (it == drafts[parent].folders.end()) {
+                const uint32_t id = static_cast<uint32_t>(drafts.size());
+                Draft folder;
+                folder.rep   = g;
+                folder.start = offset(parts[p]);
+                folder.end   = offset(parts[p]) + static_cast<uint32_t>(parts[p].size());
+                drafts.push_back(std::move(folder));
+                drafts[parent].children.push_back(id);
+                it = drafts[parent].folders.emplace(parts[p], id).first;
+            }
+            parent = it->second;
+        }
+        Draft leaf;
+        leaf.rep   = g;
+        leaf.start = offset(parts.back());
+        leaf.end   = offset(parts.back()) + static_cast<uint32_t>(parts.back().size());
+        leaf.group = g;
+        drafts[parent].children.push_back(static_cast<uint32_t>(drafts.size()));
+        drafts.push_back(std::move(leaf));
+    }
+
+    auto label = [&](const Draft& d) { return std::string_view(titles[d.rep]).substr(d.start, d.end - d.start); };
+
+    // Visita in ampiezza: i figli di ogni nodo finiscono consecutivi
+    std::vector<uint32_t> order;
+    auto appendChildren = [&](Draft& parent) {
+        for (uint32_t child : parent.children) {
+            // Cartella con un solo elemento: diventa quell'elemento, con il nome che parte
+            // dalla cartella. Tutto il sottoalbero viene dallo stesso titolo rep
+            Draft& d = drafts[child];
+            while (d.group == NONE && d.children.size() == 1) {
+                Draft& only = drafts[d.children.front()];
+                d.end       = only.end;
+                d.group     = only.group;
+                d.children  = std::move(only.children);
+            }
+        }
+        std::sort(parent.children.begin(), parent.children.end(), [&](uint32_t a, uint32_t b) {
+            const int compare = label(drafts[a]).compare(label(drafts[b]));
+            if (compare != 0) return compare < 0;
+            return (drafts[a].group == NONE) > (drafts[b].group == NONE);
+        });
+        order.insert(order.end(), parent.children.begin(), parent.children.end());
+    };
+
+    appendChildren(drafts[0]);
+    roots = static_cast<uint32_t>(order.size());
+    nodes.resize(order.size());
+    for (uint32_t id = 0; id < order.size(); ++id) {
+        Draft& d             = drafts[order[id]];
+        nodes[id].label      = std::string(label(d));
+        nodes[id].group      = d.group;
+        nodes[id].firstChild = static_cast<uint32_t>(order.size());
+        appendChildren(d);
+        nodes[id].childCount = static_cast<uint32_t>(order.size()) - nodes[id].firstChild;
+        nodes.resize(order.size());
+        for (uint32_t child = nodes[id].firstChild; child < order.size(); ++child) {
+            nodes[child].parent = id;
+            nodes[child].depth  = nodes[id].depth + 1;
+        }
+    }
+
+    // I figli seguono sempre il padre: a ritroso i conteggi sono completi
+    leaves.assign(titles.size(), NONE);
+    for (uint32_t id = static_cast<uint32_t>(nodes.size()); id-- > 0;) {
+        Node& n = nodes[id];
+        if (!n.folder()) {
+            n.groupCount    = 1;
+            leaves[n.group] = id;
+        }
+        if (n.parent != NONE) nodes[n.parent].groupCount += n.groupCount;
+    }
+}
+
+GroupTreeRows::GroupTreeRows(std::shared_ptr<const GroupTree> tree) : groups(std::move(tree)) {
+    if (!groups) return;
+    open.assign(groups->size(), false);
+    rows.resize(groups->rootCount());
+    for (uint32_t id = 0; id < rows.size(); ++id) rows[id] = id;
+    if (rows.size() == 1 && groups->node(0).folder()) toggle(0);
+}
+
+void GroupTreeRows::toggle(size_t row) {
+    if (row >= rows.size()) return;
+    const uint32_t id        = rows[row];
+    const GroupTree::Node& n = groups->node(id);
+    if (!n.folder()) return;
+
+    if (open[id]) {
+        // Via tutte le righe più interne che seguono, chiudendo anche le cartelle aperte al loro interno
+        size_t end = row + 1;
+        while (end < rows.size() && groups->node(rows[end]).depth > n.depth) open[rows[end++]] = false;
+        rows.erase(rows.begin() + row + 1, rows.begin() + end);
+        open[id] = false;
+        return;
+    }
+    std::vector<uint32_t> children(n.childCount);
+    for (uint32_t k = 0; k < n.childCount; ++k) children[k] = n.firstChild + k;
+    rows.insert(rows.begin() + row + 1, children.begin(), children.end());
+    open[id] = true;
+}
+
+size_t GroupTreeRows::reveal(uint32_t group) {
+    if (!groups) return rows.size();
+    const uint32_t id = groups->nodeOf(group);
+    if (id == GroupTree::NONE) return rows.size();
+
+    std::vector<uint32_t> ancestors;
+    for (uint32_t parent = groups->node(id).parent; parent != GroupTree::NONE; parent = groups->node(parent).parent)
+        ancestors.push_back(parent);
+    // Dalla radice: ogni cartella è visibile una volta aperta quella che la contiene
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it)
+        if (!open[*it]) toggle(rowOf(*it));
+    return rowOf(id);
+}
+
+size_t GroupTreeRows::rowOf(uint32_t node) const {
+    auto it = std::find(rows.begin(), rows.end(), node);
+    return static_cast<size_t>(it - rows.begin());
+}
+
+}  // namespace tsvitch
@@ -0,0 +1,92 @@
+#include "tsvitch/util/gzip_stream.hpp"
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace tsvitch {
+
+#ifdef USE_ZLIB
+
+struct GzipStream::Impl {
+    z_stream stream{};
+    bool initialized = false;
+    bool finished    = false;
+    bool trailing    = false;
+    // Nuovo membro iniziato ma non ha ancora prodotto dati
+    bool emptyMember = false;
+    char buffer[64 * 1024];
+};
+
+GzipStream::GzipStream(DataCallback onData) : impl(std::make_unique<Impl>()), onData(std::move(onData)) {
+    // 15 + 32: finestra massima con riconoscimento automatico di gzip e zlib
+    impl->initialized = inflateInit2(&impl->stream, 15 + 32) == Z_OK;
+}
+
+GzipStream::~GzipStream() {
+    if (impl->initialized) inflateEnd(&impl->stream);
+}
+
+bool GzipStream::feed(std::string_view chunk) {
+    if (!impl->initialized) return false;
+    if (impl->trailing) return true;
+
+    auto& stream   = impl->stream;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(chunk.data()));
+    stream.avail_in = static_cast<uInt>(chunk.size());
+
+    while (stream.avail_in > 0) {
+        if (impl->finished) {
+            // Membro gzip successivo
+            if (inflateReset(&stream) != Z_OK) return false;
+            impl->finished    = false;
+            impl->emptyMember = true;
+        }
+
+        stream.next_out  = reinterpret_cast<Bytef*>(impl->buffer);
+        stream.avail_out = sizeof(impl->buffer);
+
+        int ret         = inflate(&stream, Z_NO_FLUSH);
+        size_t produced = sizeof(impl->buffer) - stream.avail_out;
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            // Byte di riempimento dopo l'ultimo membro: vengono ignorati
+            if (impl->emptyMember && produced == 0) {
+                impl->trailing = true;
+                return true;
+            }
+            return false;
+        }
+
+        if (produced > 0) {
+            impl->emptyMember = false;
+            onData(std::string_view(impl->buffer, produced));
+        }
+
+        if (ret == Z_STREAM_END) impl->finished = true;
+        // Nessun progresso possibile: servono altri dati in ingresso
+        if (ret == Z_BUF_ERROR && produced == 0) break;
+    }
+    return true;
+}
+
+bool GzipStream::supported() { return true; }
+
+#else
+
+struct GzipStream::Impl {};
+
+GzipStream::GzipStream(DataCallback onData) : onData(std::move(onData)) {}
+
+GzipStream::~GzipStream() = default;
+
+bool GzipStream::feed(std::string_view) { return false; }
+
+bool GzipStream::supported() { return false; }
+
+#endif
+
+bool GzipStream::isGzip(std::string_view data) {
+    return data.size() >= 2 && static_cast<unsigned char>(data[0]) == 0x1F && static_cast<unsigned char>(data[1]) == 0x8B;
+}
+
+}  // namespace tsvitch
@@ -1,10 +1,44 @@
 
 
+#include <curl/curl.h>
+#include <memory>
+#include <mutex>
+
 #include "tsvitch/util/http.hpp"
 #include <borealis.hpp> // or the specific header where brls::Logger is defined
 
 namespace tsvitch {
 
+namespace {
+
+// Dati condivisi tra le sessioni di tutti i thread, ciascuno col proprio lucchetto
+class CurlShare {
+public:
+    CurlShare() : handle{curl_share_init()} {
+        curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, lock);
+        curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, unlock);
+        curl_share_setopt(handle, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        // Niente CURL_LOCK_DATA_CONNECT: libcurl non supporta la cache delle connessioni
+        // condivisa tra thread che lavorano in parallelo
+        curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    CURLSH* handle;
+
+private:
+    static void lock(CURL*, curl_lock_data data, curl_lock_access, void* self) {
+        static_cast<CurlShare*>(self)->mutexes[data].lock();
+    }
+    static void unlock(CURL*, curl_lock_data data, void* self) {
+        static_cast<CurlShare*>(self)->mutexes[data].unlock();
+    }
+
+    std::mutex mutexes[CURL_LOCK_DATA_LAST];
+};
+
+}  // namespace
+
 cpr::Response HTTP::get(const std::string& url, const cpr::Parameters& parameters, int timeout) {
     return cpr::Get(cpr::Url{url}, parameters, CPR_HTTP_BASE);
 }
@@ -19,4 +53,28 @@ void HTTP::setProxy(const std::string& proxyUrl) {
     }
 }
 
+cpr::Session& HTTP::threadSession() {
+    // Mai distrutta: le sessioni dei thread ancora attivi all'uscita la usano fino all'ultimo
+    static CurlShare* share = new CurlShare();
+    thread_local std::unique_ptr<cpr::Session> session;
+    if (!session) {
+        session = std::make_unique<cpr::Session>();
+        curl_easy_setopt(session->GetCurlHolder()->handle, CURLOPT_SHARE, share->handle);
+    }
+    return *session;
+}
+
+std::string HTTP::supportedEncodings() {
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    std::string encodings              = "identity";
+    if (info->features & CURL_VERSION_LIBZ) encodings += ", gzip, deflate";
+#ifdef CURL_VERSION_BROTLI
+    if (info->features & CURL_VERSION_BROTLI) encodings += ", br";
+#endif
+#ifdef CURL_VERSION_ZSTD
+    if (info->features & CURL_VERSION_ZSTD) encodings += ", zstd";
+#endif
+    return encodings;
+}
+
 };  // namespace tsvitch
\ No newline at end of file
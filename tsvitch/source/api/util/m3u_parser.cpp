@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+// M3U_SIMD_NONE forza il fallback portabile, per confrontarlo nel benchmark
+#if defined(M3U_SIMD_NONE)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define M3U_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define M3U_SIMD_NEON
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "tsvitch/util/m3u_parser.hpp"
+#include "utils/text_helper.hpp"
+
+namespace tsvitch {
+
+static constexpr std::string_view EXTINF_TAG = "#EXTINF:";
+static constexpr std::string_view EXTINF_LINE = "\n#EXTINF:";
+
+// Dimensione minima di un blocco per l'analisi parallela
+static constexpr size_t PARALLEL_BLOCK_SIZE = 4 * 1024 * 1024;
+
+static inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+static inline std::string_view trim(std::string_view s) {
+    while (!s.empty() && isBlank(s.front())) s.remove_prefix(1);
+    while (!s.empty() && isBlank(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+// Copia il valore dell'attributo nel campo corrispondente, ignorando le chiavi sconosciute
+static void assignAttribute(std::string_view key, std::string_view value, LiveM3u8& entry) {
+    if (value.empty()) return;
+
+    switch (key.size()) {
+        case 6:
+            if (key == "tvg-id") entry.id.assign(value.data(), value.size());
+            break;
+        case 7:
+            if (key == "tvg-rec")
+                entry.tvgRec.assign(value.data(), value.size());
+            else if (key == "catchup")
+                entry.catchup.assign(value.data(), value.size());
+            break;
+        case 8:
+            if (key == "tvg-chno")
+                entry.chno.assign(value.data(), value.size());
+            else if (key == "tvg-logo")
+                entry.logo.assign(value.data(), value.size());
+            else if (key == "tvg-name")
+                entry.tvgName = sanitizeText(value);
+            break;
+        case 11:
+            if (key == "group-title") {
+                std::string group(value);
+                std::replace(group.begin(), group.end(), ';', ' ');
+                entry.groupTitle = sanitizeText(group);
+            }
+            break;
+        case 14:
+            if (key == "catchup-source") entry.catchupSource.assign(value.data(), value.size());
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Restituisce in sequenza le posizioni di '"', ',', '=' e '\n' in un buffer.
+ * I caratteri vengono cercati 16 byte alla volta (SSE2 / NEON, altrimenti con
+ * una tabella) e le posizioni trovate in un blocco sono lette dalla maschera
+ * senza riesaminare i byte.
+ */
+class StructuralScanner {
+public:
+    StructuralScanner(const char* begin, const char* end) : begin(begin), end(end), block(begin) {
+        mask = blockMask(begin);
+    }
+
+    /// Prossima virgoletta, saltando gli altri caratteri strutturali; end se manca
+    const char* nextQuote() {
+        const char* p;
+        while ((p = next()) < end && *p != '"') {
+        }
+        return p;
+    }
+
+    /// Prossimo carattere strutturale, o end se non ce ne sono altri
+    const char* next() {
+        while (!mask) {
+            if (end - block <= static_cast<ptrdiff_t>(BLOCK_SIZE)) return end;
+            block += BLOCK_SIZE;
+            mask = blockMask(block);
+        }
+        const unsigned bit = countTrailingZeros(mask);
+        mask &= ~(LANE_MASK << bit);
+        return block + bit / LANE_BITS;
+    }
+
+private:
+#if defined(M3U_SIMD_SSE2)
+    static constexpr size_t BLOCK_SIZE  = 16;
+    static constexpr unsigned LANE_BITS = 1;
+    static constexpr uint64_t LANE_MASK = 0x1;
+#elif defined(M3U_SIMD_NEON)
+    // vshrn produce 4 bit per byte
+    static constexpr size_t BLOCK_SIZE  = 16;
+    static constexpr unsigned LANE_BITS = 4;
+    static constexpr uint64_t LANE_MASK = 0xF;
+#else
+    // Fallback portabile: 8 byte alla volta in un registro a 64 bit, il bit alto di ogni byte segnala una corrispondenza
+    static constexpr size_t BLOCK_SIZE  = 8;
+    static constexpr unsigned LANE_BITS = 8;
+    static constexpr uint64_t LANE_MASK = 0x1;
+#endif
+
+    static inline bool isStructural(char c) { return c == '"' || c == ',' || c == '=' || c == '\n'; }
+
+    static inline unsigned countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    uint64_t blockMask(const char* p) const {
+        const ptrdiff_t remaining = end - p;
+        if (remaining < static_cast<ptrdiff_t>(BLOCK_SIZE)) {
+            // Coda del buffer: niente letture oltre la fine. Se possibile si rilegge
+            // l'ultimo blocco intero e si scartano i byte già esaminati
+            if (end - begin >= static_cast<ptrdiff_t>(BLOCK_SIZE))
+                return loadMask(end - BLOCK_SIZE) >> ((BLOCK_SIZE - remaining) * LANE_BITS);
+            uint64_t result = 0;
+            for (ptrdiff_t i = 0; i < remaining; ++i)
+                if (isStructural(p[i])) result |= LANE_MASK << (i * LANE_BITS);
+            return result;
+        }
+        return loadMask(p);
+    }
+
+    static uint64_t loadMask(const char* p) {
+#if defined(M3U_SIMD_SSE2)
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))),
+                                       _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('=')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+        return static_cast<uint32_t>(_mm_movemask_epi8(m));
+#elif defined(M3U_SIMD_NEON)
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        const uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8(','))),
+                                      vorrq_u8(vceqq_u8(v, vdupq_n_u8('=')), vceqq_u8(v, vdupq_n_u8('\n'))));
+        const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        uint64_t result = 0;
+        for (unsigned i = 0; i < BLOCK_SIZE; ++i)
+            if (isStructural(p[i])) result |= LANE_MASK << (i * LANE_BITS);
+        return result;
+#else
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return zeroBytes(word ^ broadcast('"')) | zeroBytes(word ^ broadcast(',')) | zeroBytes(word ^ broadcast('=')) |
+               zeroBytes(word ^ broadcast('\n'));
+#endif
+    }
+
+    static constexpr uint64_t broadcast(char c) { return 0x0101010101010101ULL * static_cast<unsigned char>(c); }
+
+    // 0x80 in ogni byte nullo di x, senza falsi positivi
+    static inline uint64_t zeroBytes(uint64_t x) {
+        constexpr uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+        return ~(((x & low7) + low7) | x | low7);
+    }
+
+    const char* begin;
+    const char* end;
+    const char* block;
+    uint64_t mask = 0;
+};
+
+void M3uParser::parseExtInf(std::string_view extinf, LiveM3u8& entry) {
+    const char* data = extinf.data();
+    const char* end  = data + extinf.size();
+
+    StructuralScanner scanner(data, end);
+    const char* p;
+    while ((p = scanner.next()) < end) {
+        if (*p == ',') {
+            // Il titolo è tutto ciò che segue la prima virgola fuori dalle virgolette
+            entry.title = sanitizeText(std::string_view(p + 1, end - p - 1));
+            return;
+        }
+        if (*p == '"') {
+            // Valore tra virgolette senza chiave riconoscibile: saltalo per intero
+            if (scanner.nextQuote() == end) return;
+            continue;
+        }
+        if (*p == '=' && p + 1 < end && p[1] == '"') {
+            const char* keyStart = p;
+            // La chiave può seguire la virgoletta del valore precedente: tvg-logo="x"tvg-id="y"
+            while (keyStart > data && !isBlank(keyStart[-1]) && keyStart[-1] != '"') --keyStart;
+
+            scanner.next();  // virgoletta di apertura
+            const char* valueStart = p + 2;
+            const char* valueEnd   = scanner.nextQuote();
+
+            assignAttribute(std::string_view(keyStart, p - keyStart), std::string_view(valueStart, valueEnd - valueStart),
+                            entry);
+            if (valueEnd == end) return;
+        }
+    }
+}
+
+void M3uParser::parseLine(std::string_view line) {
+    line = trim(line);
+    if (line.empty()) return;
+
+    if (line[0] == '#') {
+        if (line.compare(0, EXTINF_TAG.size(), EXTINF_TAG) != 0) return;
+
+        // Un #EXTINF senza URL viene scartato: non sarebbe riproducibile
+        current   = LiveM3u8{};
+        hasExtInf = true;
+        parseExtInf(line.substr(EXTINF_TAG.size()), current);
+        return;
+    }
+
+    if (!hasExtInf) return;
+
+    current.url.assign(line.data(), line.size());
+    output.push_back(std::move(current));
+    current   = LiveM3u8{};
+    hasExtInf = false;
+}
+
+static inline std::string_view skipBom(std::string_view content) {
+    if (content.size() >= 3 && std::memcmp(content.data(), "\xEF\xBB\xBF", 3) == 0) content.remove_prefix(3);
+    return content;
+}
+
+void M3uParser::parse(std::string_view content) {
+    content = skipBom(content);
+
+    while (!content.empty()) {
+        const void* nl  = std::memchr(content.data(), '\n', content.size());
+        const size_t end = nl ? static_cast<const char*>(nl) - content.data() : content.size();
+        parseLine(content.substr(0, end));
+        content.remove_prefix(nl ? end + 1 : end);
+    }
+}
+
+void M3uParser::feed(std::string_view chunk) {
+    if (firstChunk && !chunk.empty()) {
+        firstChunk = false;
+        chunk      = skipBom(chunk);
+    }
+
+    if (workers > 1) {
+        pendingBlock.append(chunk.data(), chunk.size());
+        if (pendingBlock.size() < PARALLEL_BLOCK_SIZE) return;
+
+        // Il blocco termina subito prima dell'ultima riga #EXTINF ricevuta
+        const size_t cut = pendingBlock.rfind(EXTINF_LINE);
+        if (cut == std::string::npos) return;
+
+        std::string rest = pendingBlock.substr(cut + 1);
+        pendingBlock.resize(cut + 1);
+        dispatchBlock(std::move(pendingBlock));
+        pendingBlock = std::move(rest);
+        return;
+    }
+
+    const void* nl = std::memchr(chunk.data(), '\n', chunk.size());
+    if (!nl) {
+        partialLine.append(chunk.data(), chunk.size());
+        return;
+    }
+
+    // Completa la riga rimasta a metà dal blocco precedente
+    size_t end = static_cast<const char*>(nl) - chunk.data();
+    if (!partialLine.empty()) {
+        partialLine.append(chunk.data(), end);
+        parseLine(partialLine);
+        partialLine.clear();
+    } else {
+        parseLine(chunk.substr(0, end));
+    }
+    chunk.remove_prefix(end + 1);
+
+    // Le righe complete vengono analizzate direttamente dal buffer di cpr, senza copie
+    while ((nl = std::memchr(chunk.data(), '\n', chunk.size())) != nullptr) {
+        end = static_cast<const char*>(nl) - chunk.data();
+        parseLine(chunk.substr(0, end));
+        chunk.remove_prefix(end + 1);
+    }
+    partialLine.assign(chunk.data(), chunk.size());
+}
+
+void M3uParser::finish() {
+    if (workers > 1) {
+        if (!pendingBlock.empty()) dispatchBlock(std::move(pendingBlock));
+        pendingBlock.clear();
+        collectBlocks(0);
+        return;
+    }
+
+    if (!partialLine.empty()) {
+        parseLine(partialLine);
+        partialLine.clear();
+    }
+}
+
+void M3uParser::dispatchBlock(std::string block) {
+    // Al più "workers" blocchi in analisi contemporaneamente
+    collectBlocks(workers - 1);
+    blocks.push_back(std::async(std::launch::async, [block = std::move(block)]() { return parseAll(block); }));
+}
+
+void M3uParser::collectBlocks(size_t keep) {
+    while (!blocks.empty() &&
+           (blocks.size() > keep || blocks.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+        LiveM3u8ListResult part = blocks.front().get();
+        blocks.pop_front();
+        output.insert(output.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    }
+}
+
+size_t M3uParser::estimateCount(std::string_view content) {
+    // In media ogni canale occupa due righe: #EXTINF e URL
+    return std::count(content.begin(), content.end(), '\n') / 2 + 1;
+}
+
+LiveM3u8ListResult M3uParser::parseAll(std::string_view content, size_t workers) {
+    LiveM3u8ListResult result;
+    if (content.empty()) return result;
+
+    if (workers > 1 && content.size() >= 2 * PARALLEL_BLOCK_SIZE) {
+        content = skipBom(content);
+        workers = std::min(workers, content.size() / PARALLEL_BLOCK_SIZE);
+
+        // Divide il buffer in intervalli di dimensione simile, ciascuno allineato a una riga #EXTINF
+        std::vector<std::future<LiveM3u8ListResult>> parts;
+        size_t start = 0;
+        for (size_t i = 1; i <= workers && start < content.size(); ++i) {
+            size_t end = content.size();
+            if (i < workers) {
+                end = content.find(EXTINF_LINE, std::max(start, content.size() / workers * i));
+                end = end == std::string_view::npos ? content.size() : end + 1;
+            }
+            parts.push_back(std::async(std::launch::async,
+                                       [range = content.substr(start, end - start)]() { return parseAll(range); }));
+            start = end;
+        }
+
+        std::vector<LiveM3u8ListResult> parsed;
+        parsed.reserve(parts.size());
+        size_t total = 0;
+        for (auto& part : parts) {
+            parsed.push_back(part.get());
+            total += parsed.back().size();
+        }
+        result.reserve(total);
+        for (auto& part : parsed)
+            result.insert(result.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+        return result;
+    }
+
+    result.reserve(estimateCount(content));
+    M3uParser parser(result);
+    parser.parse(content);
+    return result;
+}
+
+}  // namespace tsvitch
@@ -0,0 +1,63 @@
+#include "tsvitch/util/mapped_file.hpp"
+
+#include <cstdio>
+
+#if !defined(_WIN32) && !defined(__SWITCH__) && !defined(__PSV__) && !defined(PS4)
+#define TSVITCH_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tsvitch {
+
+MappedFile::~MappedFile() {
+#ifdef TSVITCH_HAS_MMAP
+    if (isMapped) munmap(const_cast<char*>(ptr), length);
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+
+#ifdef TSVITCH_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    file->length = static_cast<size_t>(st.st_size);
+    if (file->length > 0) {
+        void* addr = mmap(nullptr, file->length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            file->ptr      = static_cast<const char*>(addr);
+            file->isMapped = true;
+        }
+    }
+    ::close(fd);
+    if (file->isMapped || file->length == 0) return file;
+    // mmap non riuscito (es. filesystem che non lo supporta): lettura normale
+#endif
+
+    FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp) return nullptr;
+    std::fseek(fp, 0, SEEK_END);
+    long size = std::ftell(fp);
+    std::fseek(fp, 0, SEEK_SET);
+    if (size < 0) {
+        std::fclose(fp);
+        return nullptr;
+    }
+    file->length = static_cast<size_t>(size);
+    file->buffer.reset(new uint64_t[(file->length + sizeof(uint64_t) - 1) / sizeof(uint64_t) + 1]);
+    file->ptr  = reinterpret_cast<const char*>(file->buffer.get());
+    size_t got = std::fread(file->buffer.get(), 1, file->length, fp);
+    std::fclose(fp);
+    if (got != file->length) return nullptr;
+    return file;
+}
+
+}  // namespace tsvitch
@@ -0,0 +1,148 @@
+#include "tsvitch/util/thumbnail.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace tsvitch {
+
+namespace {
+
+constexpr char THUMBNAIL_MAGIC[4]    = {'T', 'S', 'V', 'T'};
+constexpr uint16_t THUMBNAIL_VERSION = 1;
+constexpr uint16_t FLAG_DEFLATE      = 1;
+// Oltre questa dimensione non è una miniatura
+constexpr uint32_t THUMBNAIL_MAX_SIDE = 8192;
+
+struct ThumbnailHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint32_t size;  // byte dei pixel non compressi
+};
+
+}  // namespace
+
+Thumbnail Thumbnail::fromRGBA(const uint8_t* rgba, int width, int height, int boxWidth, int boxHeight, int border) {
+    Thumbnail thumbnail;
+    if (!rgba || width <= 0 || height <= 0) return thumbnail;
+
+    // Scala che copre il riquadro, qualunque sia il modo in cui la vista adatta l'immagine
+    double scale = 1.0;
+    if (boxWidth > 0 && boxHeight > 0)
+        scale = std::min(1.0, std::max(double(boxWidth) / width, double(boxHeight) / height));
+    const int w = std::clamp(int(std::lround(width * scale)), 1, width);
+    const int h = std::clamp(int(std::lround(height * scale)), 1, height);
+
+    thumbnail.width  = w + border * 2;
+    thumbnail.height = h + border * 2;
+    thumbnail.pixels.assign(size_t(thumbnail.width) * thumbnail.height * 4, 0);
+
+    // Colonna della miniatura di ogni colonna dell'immagine, e quante ne raccoglie
+    std::vector<uint32_t> columnOf(width);
+    std::vector<uint32_t> columnSize(w, 0);
+    for (int x = 0; x < width; ++x) {
+        columnOf[x] = uint32_t(uint64_t(x) * w / width);
+        ++columnSize[columnOf[x]];
+    }
+
+    // Somme di r*a, g*a, b*a e a per ogni pixel della riga di miniatura in corso
+    std::vector<uint64_t> sums(size_t(w) * 4, 0);
+    uint32_t rows = 0;
+    int row       = 0;
+    auto flush    = [&]() {
+        uint8_t* out = thumbnail.pixels.data() + (size_t(row + border) * thumbnail.width + border) * 4;
+        for (int c = 0; c < w; ++c) {
+            const uint64_t count = uint64_t(columnSize[c]) * rows;
+            const uint64_t* sum  = &sums[size_t(c) * 4];
+            for (int k = 0; k < 3; ++k) out[c * 4 + k] = uint8_t((sum[k] + 255 * count / 2) / (255 * count));
+            out[c * 4 + 3] = uint8_t((sum[3] + count / 2) / count);
+        }
+        std::fill(sums.begin(), sums.end(), 0);
+        rows = 0;
+    };
+
+    for (int y = 0; y < height; ++y) {
+        const int target = int(uint64_t(y) * h / height);
+        if (target != row) {
+            flush();
+            row = target;
+        }
+        const uint8_t* in = rgba + size_t(y) * width * 4;
+        for (int x = 0; x < width; ++x, in += 4) {
+            uint64_t* sum = &sums[size_t(columnOf[x]) * 4];
+            const uint32_t alpha = in[3];
+            sum[0] += in[0] * alpha;
+            sum[1] += in[1] * alpha;
+            sum[2] += in[2] * alpha;
+            sum[3] += alpha;
+        }
+        ++rows;
+    }
+    flush();
+    return thumbnail;
+}
+
+std::string Thumbnail::encode() const {
+    ThumbnailHeader header{};
+    std::memcpy(header.magic, THUMBNAIL_MAGIC, sizeof(THUMBNAIL_MAGIC));
+    header.version = THUMBNAIL_VERSION;
+    header.width   = uint32_t(width);
+    header.height  = uint32_t(height);
+    header.size    = uint32_t(pixels.size());
+
+    std::string data(sizeof(header), '\0');
+#ifdef USE_ZLIB
+    // Livello minimo: i loghi hanno grandi aree uniformi, si comprimono bene anche così
+    uLongf compressed = compressBound(uLong(pixels.size()));
+    data.resize(sizeof(header) + compressed);
+    if (compress2(reinterpret_cast<Bytef*>(&data[sizeof(header)]), &compressed, pixels.data(), uLong(pixels.size()),
+                  Z_BEST_SPEED) == Z_OK) {
+        data.resize(sizeof(header) + compressed);
+        header.flags = FLAG_DEFLATE;
+    } else {
+        data.resize(sizeof(header));
+    }
+#endif
+    if (header.flags == 0) data.append(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    std::memcpy(&data[0], &header, sizeof(header));
+    return data;
+}
+
+bool Thumbnail::decode(std::string_view data, Thumbnail& out) {
+    ThumbnailHeader header{};
+    if (data.size() < sizeof(header)) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, THUMBNAIL_MAGIC, sizeof(THUMBNAIL_MAGIC)) != 0 ||
+        header.version != THUMBNAIL_VERSION || header.width == 0 || header.height == 0 ||
+        header.width > THUMBNAIL_MAX_SIDE || header.height > THUMBNAIL_MAX_SIDE ||
+        header.size != uint64_t(header.width) * header.height * 4)
+        return false;
+
+    const std::string_view body = data.substr(sizeof(header));
+    out.width                   = int(header.width);
+    out.height                  = int(header.height);
+    out.pixels.resize(header.size);
+    if (header.flags == 0) {
+        if (body.size() != header.size) return false;
+        std::memcpy(out.pixels.data(), body.data(), body.size());
+        return true;
+    }
+#ifdef USE_ZLIB
+    if (header.flags == FLAG_DEFLATE) {
+        uLongf size = header.size;
+        return uncompress(out.pixels.data(), &size, reinterpret_cast<const Bytef*>(body.data()), uLong(body.size())) ==
+                   Z_OK &&
+               size == header.size;
+    }
+#endif
+    return false;
+}
+
+}  // namespace tsvitch
@@ -3,7 +3,6 @@
 #include <utility>
 #include <vector>
 #include <algorithm>
-#include <regex>
 #include <thread>
 #include <chrono>
 
@@ -13,11 +12,15 @@
 #include "borealis/core/application.hpp"
 
 #include "tsvitch/result/home_live_result.h"
+#include "tsvitch/util/m3u_parser.hpp"
+#include "tsvitch/util/channel_view.hpp"
+#include "tsvitch/util/gzip_stream.hpp"
+#include "utils/text_helper.hpp"
 #include "utils/config_helper.hpp"
+#include "core/ChannelManager.hpp"
 
 namespace tsvitch {
 
-/// Pulisce il testo rimuovendo caratteri che potrebbero causare problemi di rendering
 // Helper function to safely get string value from JSON, handling null values
 static std::string safeGetString(const nlohmann::json& json, const std::string& key, const std::string& defaultValue = "") {
     if (!json.contains(key) || json[key].is_null()) {
@@ -29,33 +32,6 @@ static std::string safeGetString(const nlohmann::json& json, const std::string&
     return defaultValue;
 }
 
-// Helper function to sanitize text for safe font rendering
-static std::string sanitizeText(const std::string& text) {
-    if (text.empty()) return text;
-    
-    std::string cleaned = text;
-    
-    // Rimuovi caratteri di controllo ASCII (0-31, eccetto tab, newline, carriage return)
-    cleaned.erase(std::remove_if(cleaned.begin(), cleaned.end(), [](unsigned char c) {
-        return (c < 32 && c != 9 && c != 10 && c != 13) || c == 127;
-    }), cleaned.end());
-    
-    // Sostituisci caratteri problematici con versioni sicure
-    std::replace(cleaned.begin(), cleaned.end(), '\n', ' ');
-    std::replace(cleaned.begin(), cleaned.end(), '\r', ' ');
-    std::replace(cleaned.begin(), cleaned.end(), '\t', ' ');
-    
-    // Rimuovi spazi multipli
-    std::regex multiple_spaces("\\s+");
-    cleaned = std::regex_replace(cleaned, multiple_spaces, " ");
-    
-    // Trim
-    cleaned.erase(0, cleaned.find_first_not_of(" \t\n\r\f\v"));
-    cleaned.erase(cleaned.find_last_not_of(" \t\n\r\f\v") + 1);
-    
-    return cleaned;
-}
-
 /// Découpe une chaîne `a,b,c` -> {"a","b","c"}
 static std::vector<std::string> split_csv(const std::string& csv)
 {
@@ -68,125 +44,50 @@ static std::vector<std::string> split_csv(const std::string& csv)
     return out;
 }
 
-nlohmann::json parse_m3u8_to_json(const std::string& m3u8_content)
-{
-    if (m3u8_content.empty()) {
-        return nlohmann::json::array();
+// Hash esadecimale del contenuto, confrontato con quello della cache per
+// riconoscere una sorgente invariata anche senza ETag / Last-Modified
+static std::string md5Hex(websocketpp::md5::md5_state_t& state) {
+    websocketpp::md5::md5_byte_t digest[16];
+    websocketpp::md5::md5_finish(&state, digest);
+    std::string hex;
+    hex.reserve(32);
+    for (auto byte : digest) {
+        hex.push_back(websocketpp::md5::hexval[byte >> 4]);
+        hex.push_back(websocketpp::md5::hexval[byte & 0x0F]);
     }
+    return hex;
+}
 
-    std::istringstream stream(m3u8_content);
-    std::string        line;
-    nlohmann::json     json_result = nlohmann::json::array();
-    nlohmann::json     current_entry;
-    
-    // Pre-allocazione ottimizzata per migliorare prestazioni
-    size_t estimated_channels = std::count(m3u8_content.begin(), m3u8_content.end(), '\n') / 3;
-    json_result.get_ref<nlohmann::json::array_t&>().reserve(estimated_channels + 100);
-
-    // Buffer riutilizzabile per evitare allocazioni
-    std::string extinf_buffer;
-    extinf_buffer.reserve(512);
-
-    while (std::getline(stream, line)) {
-        // Trim veloce di \r\n alla fine
-        while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
-            line.pop_back();
-        }
-        
-        // Controllo ultra-rapido per saltare linee vuote o commenti non EXTINF
-        if (line.empty() || (line[0] == '#' && (line.size() < 8 || line.compare(0, 8, "#EXTINF:") != 0))) {
-            continue;
-        }
-        
-        if (line.compare(0, 8, "#EXTINF:") == 0) {
-            if (!current_entry.empty()) {
-                json_result.push_back(std::move(current_entry));
-                current_entry.clear();
-            }
-
-            extinf_buffer = line.substr(8);
-            
-            // Parsing ultra-ottimizzato con una sola passata della stringa
-            const char* data = extinf_buffer.c_str();
-            const size_t len = extinf_buffer.length();
-            
-            // Cerca i pattern più comuni per primi (ottimizzazione basata su frequenza)
-            size_t comma_pos = std::string::npos;
-            size_t tvg_id_start = 0, tvg_id_len = 0;
-            size_t tvg_chno_start = 0, tvg_chno_len = 0;
-            size_t tvg_logo_start = 0, tvg_logo_len = 0;
-            size_t group_title_start = 0, group_title_len = 0;
-            
-            for (size_t i = 0; i < len; ++i) {
-                // Cerca comma (titolo) - più frequente
-                if (data[i] == ',' && comma_pos == std::string::npos) {
-                    comma_pos = i;
-                }
-                // Cerca tvg-id
-                else if (data[i] == 't' && i + 7 < len && memcmp(data + i, "tvg-id=\"", 8) == 0) {
-                    i += 8;
-                    tvg_id_start = i;
-                    while (i < len && data[i] != '"') ++i;
-                    tvg_id_len = i - tvg_id_start;
-                }
-                // Cerca group-title
-                else if (data[i] == 'g' && i + 12 < len && memcmp(data + i, "group-title=\"", 13) == 0) {
-                    i += 13;
-                    group_title_start = i;
-                    while (i < len && data[i] != '"') ++i;
-                    group_title_len = i - group_title_start;
-                }
-                // Cerca tvg-chno
-                else if (data[i] == 't' && i + 9 < len && memcmp(data + i, "tvg-chno=\"", 10) == 0) {
-                    i += 10;
-                    tvg_chno_start = i;
-                    while (i < len && data[i] != '"') ++i;
-                    tvg_chno_len = i - tvg_chno_start;
-                }
-                // Cerca tvg-logo
-                else if (data[i] == 't' && i + 9 < len && memcmp(data + i, "tvg-logo=\"", 10) == 0) {
-                    i += 10;
-                    tvg_logo_start = i;
-                    while (i < len && data[i] != '"') ++i;
-                    tvg_logo_len = i - tvg_logo_start;
-                }
-            }
-
-            // Assegna i valori trovati (solo se non vuoti)
-            if (tvg_id_len > 0) {
-                current_entry["id"] = std::string(data + tvg_id_start, tvg_id_len);
-            }
-            if (tvg_chno_len > 0) {
-                current_entry["chno"] = std::string(data + tvg_chno_start, tvg_chno_len);
-            }
-            if (tvg_logo_len > 0) {
-                current_entry["logo"] = std::string(data + tvg_logo_start, tvg_logo_len);
-            }
-            if (group_title_len > 0) {
-                current_entry["groupTitle"] = sanitizeText(std::string(data + group_title_start, group_title_len));
-            }
-            if (comma_pos != std::string::npos && comma_pos + 1 < len) {
-                current_entry["title"] = sanitizeText(extinf_buffer.substr(comma_pos + 1));
-            }
-        } else if (!line.empty() && line[0] != '#') {
-            current_entry["url"] = std::move(line);
-        }
-    }
+static std::string responseHeader(const cpr::Response& r, const char* name) {
+    auto it = r.header.find(name);
+    return it != r.header.end() ? it->second : std::string{};
+}
 
-    // Aggiungi l'ultimo entry se presente e valido
-    if (!current_entry.empty() && current_entry.contains("id")) {
-        json_result.push_back(std::move(current_entry));
-    }
-    
+// Numero di canali dopo il quale viene inviata un'anteprima della playlist ancora in download
+static constexpr size_t M3U8_PREVIEW_CHANNELS = 2000;
 
-#ifdef DEBUG
-    std::cout << "json_result:\n" << json_result.dump(2) << std::endl;
-#endif
-    return json_result;
-}
+// Stato condiviso tra il write callback di cpr e il callback finale
+struct M3u8StreamState {
+    // Il parser produce LiveM3u8 a piccoli lotti, spostati nello store dopo ogni blocco
+    LiveM3u8ListResult batch;
+    M3uParser parser{batch, M3uParser::PARSE_THREADS};
+    ChannelStore store;
+    size_t downloadedBytes = 0;
+    bool firstChunk        = true;
+    // Presente solo se il corpo è un file .gz senza Content-Encoding (decompresso da libcurl)
+    std::unique_ptr<GzipStream> gunzip;
+    std::chrono::microseconds parseTime{0};
+    // Calcolato sui byte ricevuti, prima della decompressione del .gz
+    websocketpp::md5::md5_state_t hash;
+    bool previewSent = false;
+    std::shared_ptr<std::atomic<bool>> cancellationToken = std::make_shared<std::atomic<bool>>(false);
+    brls::Event<>::Subscription exitSubscription;
+};
 
-void TsVitchClient::get_file_m3u8(const std::function<void(LiveM3u8ListResult)>& callback,
-                                  const ErrorCallback&                           error)
+void TsVitchClient::get_file_m3u8(const std::function<void(ChannelGroups)>& callback,
+                                  const ErrorCallback&                           error,
+                                  const std::function<void(ChannelGroups)>& preview,
+                                  const std::function<void()>&                   notModified)
 {
     auto m3u8Url = ProgramConfig::instance().getM3U8Url();
     auto timeoutMs = ProgramConfig::instance().getIntOption(SettingItem::M3U8_TIMEOUT);
@@ -194,194 +95,145 @@ void TsVitchClient::get_file_m3u8(const std::function<void(LiveM3u8ListResult)>&
     // Timeout più intelligente basato sulla dimensione prevista
     if (timeoutMs < 30000) timeoutMs = 30000; // Minimum 30 secondi per file M3U8 grandi
     
-    brls::Logger::info("Fetching M3U8 playlist from: {} (timeout: {}ms)", m3u8Url, timeoutMs);
-    
-    HTTP::__cpr_get(
-        m3u8Url,
-        {},
-        timeoutMs,
-        [callback, error](const cpr::Response& r) {
-            // Log dimensione risposta per debug prestazioni
-            brls::Logger::info("M3U8 download completed - Size: {} bytes, Status: {}", r.text.size(), r.status_code);
-            
-#ifdef __SWITCH__
-            // Per file molto grandi, usa sempre parsing asincrono anche su Switch
-            bool useAsyncParsing = r.text.size() > 1024 * 1024; // 1MB threshold
-            
-            // Switch: usa parsing sincrono per file piccoli, asincrono per file grandi
-            if (useAsyncParsing) {
-                brls::Logger::info("Large M3U8 file detected ({}MB), using async parsing on Switch", r.text.size() / (1024*1024));
-                
-                // Create a cancellation token 
-                auto cancellationToken = std::make_shared<std::atomic<bool>>(false);
-                
-                // Subscribe to exit event to cancel parsing
-                auto exitSubscription = brls::Application::getExitEvent()->subscribe([cancellationToken]() {
-                    brls::Logger::info("M3U8 parsing: Exit event received, setting cancellation flag");
-                    cancellationToken->store(true);
-                });
-                
-                brls::Threading::async([callback, error, responseText = std::move(r.text), cancellationToken, exitSubscription]() {
-                    try {
-                        // Check if parsing should be canceled
-                        if (cancellationToken->load()) {
-                            brls::Logger::info("M3U8 async parsing canceled before start - application is exiting");
-                            brls::Application::getExitEvent()->unsubscribe(exitSubscription);
-                            return;
-                        }
-                        
-                        auto start_time = std::chrono::high_resolution_clock::now();
-                        nlohmann::json json_result = parse_m3u8_to_json(responseText);
-                        
-                        // Check again if parsing should be canceled
-                        if (cancellationToken->load()) {
-                            brls::Logger::info("M3U8 async parsing canceled during execution - application is exiting");
-                            brls::Application::getExitEvent()->unsubscribe(exitSubscription);
-                            return;
-                        }
-                        
-                        auto end_time = std::chrono::high_resolution_clock::now();
-                        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-                        brls::Logger::info("Switch async M3U8 parsing completed in {}ms, found {} channels", duration.count(), json_result.size());
+    brls::Logger::info("Fetching M3U8 playlist from: {} (timeout: {}ms, encodings: {})", m3u8Url, timeoutMs,
+                       HTTP::supportedEncodings());
 
-                        LiveM3u8ListResult result;
-                        result.reserve(json_result.size());
-                        
-                        for (const auto& item : json_result) {
-                            LiveM3u8 live;
-                            live.id         = item.value("id", "");
-                            live.chno       = item.value("chno", "");
-                            live.logo       = item.value("logo", "");
-                            {
-                                std::string groupTitle = item.value("groupTitle", "");
-                                std::replace(groupTitle.begin(), groupTitle.end(), ';', ' ');
-                                live.groupTitle = sanitizeText(groupTitle);
-                            }
-                            live.title      = sanitizeText(item.value("title", ""));
-                            live.url        = item.value("url", "");
-                            result.push_back(std::move(live));
-                        }
-                        
-                        // Final check before calling callback
-                        if (cancellationToken->load()) {
-                            brls::Logger::info("M3U8 async parsing canceled before callback - application is exiting");
-                            brls::Application::getExitEvent()->unsubscribe(exitSubscription);
-                            return;
-                        }
-                        
-                        brls::sync([callback, result = std::move(result), cancellationToken, exitSubscription]() {
-                            // Check once more in sync context
-                            if (cancellationToken->load()) {
-                                brls::Logger::info("M3U8 sync callback canceled - application is exiting");
-                                brls::Application::getExitEvent()->unsubscribe(exitSubscription);
-                                return;
-                            }
-                            CALLBACK(result);
-                            brls::Application::getExitEvent()->unsubscribe(exitSubscription);
-                        });
-                    } catch (const std::exception& e) {
-                        brls::Logger::error("Switch async M3U8 parsing error: {}", e.what());
-                        
-                        // Don't call error callback if app is exiting
-                        if (cancellationToken->load()) {
-                            brls::Logger::info("M3U8 async error callback canceled - application is exiting");
-                            brls::Application::getExitEvent()->unsubscribe(exitSubscription);
-                            return;
-                        }
-                        
-                        brls::sync([error, cancellationToken, exitSubscription]() {
-                            if (cancellationToken->load()) {
-                                brls::Logger::info("M3U8 sync error callback canceled - application is exiting");
-                                brls::Application::getExitEvent()->unsubscribe(exitSubscription);
-                                return;
-                            }
-                            ERROR_MSG("cannot get file m3u8", -1);
-                            error("Failed to parse m3u8 content", -1);
-                            brls::Application::getExitEvent()->unsubscribe(exitSubscription);
-                        });
-                    }
-                });
-            } else {
-                // File piccoli: parsing sincrono ottimizzato
-                try {
-                    auto start_time = std::chrono::high_resolution_clock::now();
-                    nlohmann::json json_result = parse_m3u8_to_json(r.text);
-                    auto end_time = std::chrono::high_resolution_clock::now();
-                    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-                    brls::Logger::info("Switch sync M3U8 parsing completed in {}ms, found {} channels", duration.count(), json_result.size());
+    // Il parsing avviene mentre i dati arrivano, sul thread di cpr: il corpo
+    // della risposta non viene mai accumulato per intero in memoria
+    auto state               = std::make_shared<M3u8StreamState>();
+    auto cancellationToken   = state->cancellationToken;
+    websocketpp::md5::md5_init(&state->hash);
 
-                    LiveM3u8ListResult result;
-                    result.reserve(json_result.size());
-                    
-                    for (const auto& item : json_result) {
-                        LiveM3u8 live;
-                        live.id         = item.value("id", "");
-                        live.chno       = item.value("chno", "");
-                        live.logo       = item.value("logo", "");
-                        {
-                            std::string groupTitle = item.value("groupTitle", "");
-                            std::replace(groupTitle.begin(), groupTitle.end(), ';', ' ');
-                            live.groupTitle = sanitizeText(groupTitle);
-                        }
-                        live.title      = sanitizeText(item.value("title", ""));
-                        live.url        = item.value("url", "");
-                        result.push_back(std::move(live));
+    // Richiesta condizionale solo se il chiamante sa gestire una sorgente invariata
+    CacheValidators cached;
+    if (notModified) cached = ChannelManager::get()->loadValidators(m3u8Url);
+    auto headers = HTTP::conditionalHeaders(cached.etag, cached.lastModified);
+    state->exitSubscription  = brls::Application::getExitEvent()->subscribe([cancellationToken]() {
+        brls::Logger::info("M3U8 download: Exit event received, setting cancellation flag");
+        cancellationToken->store(true);
+    });
+    auto downloadStart = std::chrono::steady_clock::now();
+
+    HTTP::__cpr_get_stream(
+        m3u8Url, timeoutMs, headers,
+        [state, preview](std::string_view data) {
+            // Restituire false interrompe il trasferimento
+            if (state->cancellationToken->load()) return false;
+
+            if (state->firstChunk && !data.empty()) {
+                state->firstChunk = false;
+                if (GzipStream::isGzip(data)) {
+                    if (!GzipStream::supported()) {
+                        brls::Logger::error("M3U8 playlist is gzip-compressed but zlib is not available");
+                        return false;
                     }
-                    
-                    CALLBACK(result);
-                } catch (const std::exception& e) {
-                    brls::Logger::error("Switch sync M3U8 parsing error: {}", e.what());
-                    ERROR_MSG("cannot get file m3u8", -1);
-                    error("Failed to parse m3u8 content", -1);
+                    brls::Logger::info("M3U8 playlist is gzip-compressed, decompressing while downloading");
+                    auto* parser  = &state->parser;
+                    state->gunzip = std::make_unique<GzipStream>([parser](std::string_view plain) { parser->feed(plain); });
                 }
             }
-#else
-            // Altre piattaforme: sempre parsing asincrono per migliori prestazioni
-            brls::Threading::async([callback, error, responseText = std::move(r.text)]() {
-                try {
-                    auto start_time = std::chrono::high_resolution_clock::now();
-                    nlohmann::json json_result = parse_m3u8_to_json(responseText);
-                    auto end_time = std::chrono::high_resolution_clock::now();
-                    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-                    brls::Logger::info("M3U8 parsing completed in {}ms, found {} channels", duration.count(), json_result.size());
 
-                    LiveM3u8ListResult result;
-                    result.reserve(json_result.size());
-                    
-                    for (const auto& item : json_result) {
-                        LiveM3u8 live;
-                        live.id         = item.value("id", "");
-                        live.chno       = item.value("chno", "");
-                        live.logo       = item.value("logo", "");
-                        {
-                            std::string groupTitle = item.value("groupTitle", "");
-                            std::replace(groupTitle.begin(), groupTitle.end(), ';', ' ');
-                            live.groupTitle = sanitizeText(groupTitle);
-                        }
-                        live.title      = sanitizeText(item.value("title", ""));
-                        live.url        = item.value("url", "");
-                        result.push_back(std::move(live));
-                    }
-                    
-                    brls::sync([callback, result = std::move(result)]() {
-                        CALLBACK(result);
-                    });
-                } catch (const std::exception& e) {
-                    brls::Logger::error("M3U8 parsing error: {}", e.what());
-                    brls::sync([error]() {
-                        ERROR_MSG("cannot get file m3u8", -1);
-                        error("Failed to parse m3u8 content", -1);
-                    });
+            auto start = std::chrono::steady_clock::now();
+            websocketpp::md5::md5_append(&state->hash, reinterpret_cast<const websocketpp::md5::md5_byte_t*>(data.data()),
+                                         data.size());
+            try {
+                if (!state->gunzip) {
+                    state->parser.feed(data);
+                } else if (!state->gunzip->feed(data)) {
+                    brls::Logger::error("M3U8 gzip stream is corrupted");
+                    return false;
+                }
+            } catch (const std::exception& e) {
+                brls::Logger::error("M3U8 parsing error: {}", e.what());
+                return false;
+            }
+            for (const auto& channel : state->batch) state->store.push_back(channel);
+            state->batch.clear();
+            state->parseTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            state->downloadedBytes += data.size();
+
+            if (preview && !state->previewSent && state->store.size() >= M3U8_PREVIEW_CHANNELS) {
+                state->previewSent = true;
+                ChannelGroups partial(std::make_shared<const ChannelStore>(state->store));
+                brls::sync([preview, partial = std::move(partial), cancellationToken = state->cancellationToken]() mutable {
+                    if (cancellationToken->load()) return;
+                    preview(std::move(partial));
+                });
+            }
+            return true;
+        },
+        [state, callback, error, notModified, downloadStart, m3u8Url, cached](const cpr::Response& r) {
+            brls::Application::getExitEvent()->unsubscribe(state->exitSubscription);
+            if (state->cancellationToken->load()) {
+                brls::Logger::info("M3U8 download canceled - application is exiting");
+                return;
+            }
+
+            if (r.status_code == 304) {
+                brls::Logger::info("M3U8 playlist not modified (304), keeping cached channels");
+                brls::sync([notModified, error]() {
+                    if (notModified) notModified();
+                    else ERROR_MSG("Unexpected 304 response", 304);
+                });
+                return;
+            }
+
+            try {
+                state->parser.finish();
+                for (const auto& channel : state->batch) state->store.push_back(channel);
+                state->batch = {};
+            } catch (const std::exception& e) {
+                brls::Logger::error("M3U8 parsing error: {}", e.what());
+                brls::sync([error]() { ERROR_MSG("Failed to parse m3u8 content", -1); });
+                return;
+            }
+            auto total = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - downloadStart);
+            auto encoding = r.header.find("Content-Encoding");
+            brls::Logger::info("M3U8 download completed - Size: {} bytes ({} bytes transferred, encoding: {}{}), Status: {}",
+                               state->downloadedBytes, r.downloaded_bytes,
+                               encoding != r.header.end() ? encoding->second : "identity", state->gunzip ? ", gzip file" : "",
+                               r.status_code);
+            brls::Logger::info("M3U8 streaming parse completed in {}ms ({}ms parsing), found {} channels", total.count(),
+                               state->parseTime.count() / 1000, state->store.size());
+            brls::Logger::info("M3U8 channel store: {} KB", state->store.memoryUsage() / 1024);
+
+            // Il server non supporta i validatori ma il contenuto è identico a quello in cache
+            auto contentHash = md5Hex(state->hash);
+            if (notModified && !cached.contentHash.empty() && contentHash == cached.contentHash) {
+                brls::Logger::info("M3U8 playlist unchanged (same content hash), keeping cached channels");
+                brls::sync([notModified]() { notModified(); });
+                return;
+            }
+            // Canali di uno stesso gruppo contigui: la cache li salva così e può leggerne un gruppo alla volta
+            state->store.sortByGroup();
+            ChannelManager::get()->setPendingValidators(
+                {m3u8Url, responseHeader(r, "ETag"), responseHeader(r, "Last-Modified"), contentHash});
+
+            // Indice dei gruppi costruito qui: il main thread lo riceve pronto
+            ChannelGroups result(std::make_shared<const ChannelStore>(std::move(state->store)));
+            brls::sync([callback, result = std::move(result), cancellationToken = state->cancellationToken]() mutable {
+                if (cancellationToken->load()) {
+                    brls::Logger::info("M3U8 sync callback canceled - application is exiting");
+                    return;
                 }
+                CALLBACK(std::move(result));
             });
-#endif
         },
-        error);
+        [state, error](const std::string& msg, int code) {
+            brls::Application::getExitEvent()->unsubscribe(state->exitSubscription);
+            if (state->cancellationToken->load()) {
+                brls::Logger::info("M3U8 error callback canceled - application is exiting");
+                return;
+            }
+            brls::Logger::error("cannot get file m3u8: {}", msg);
+            brls::sync([error, msg, code]() { ERROR_MSG(msg, code); });
+        });
 }
 
-void TsVitchClient::get_xtream_channels(const std::function<void(LiveM3u8ListResult)>& callback,
-                                       const ErrorCallback& error) {
-    get_xtream_channels_with_retry(callback, error, 3); // Max 3 retry attempts
+void TsVitchClient::get_xtream_channels(const std::function<void(ChannelGroups)>& callback,
+                                       const ErrorCallback& error,
+                                       const std::function<void()>& notModified) {
+    get_xtream_channels_with_retry(callback, error, 3, notModified); // Max 3 retry attempts
 }
 
 /**
@@ -389,9 +241,11 @@ void TsVitchClient::get_xtream_channels(const std::function<void(LiveM3u8ListRes
  * Timeout: 45+ seconds (Xtream servers typically slower than M3U8 sources)
  * Retries: 3 attempts with exponential backoff (1s network, 3s server errors)
  * Error Handling: Network errors retry, server errors 502/503 retry, 4xx no retry
+ * Revalidation: with notModified set, 304 or an unchanged body skip the JSON parsing
  */
-void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(LiveM3u8ListResult)>& callback,
-                                                  const ErrorCallback& error, int maxRetries) {
+void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(ChannelGroups)>& callback,
+                                                  const ErrorCallback& error, int maxRetries,
+                                                  const std::function<void()>& notModified) {
     auto serverUrl = ProgramConfig::instance().getXtreamServerUrl();
     auto username = ProgramConfig::instance().getXtreamUsername();
     auto password = ProgramConfig::instance().getXtreamPassword();
@@ -415,10 +269,13 @@ void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(Live
     auto timeoutMs = ProgramConfig::instance().getIntOption(SettingItem::M3U8_TIMEOUT);
     // Use longer timeout for Xtream API (typically slower than M3U8 sources)
     if (timeoutMs < 45000) timeoutMs = 45000; // Minimum 45 seconds for Xtream
+
+    CacheValidators cached;
+    if (notModified) cached = ChannelManager::get()->loadValidators(xtreamUrl);
     
     // Use cpr::GetCallback per migliori prestazioni asincrono
     cpr::GetCallback(
-        [callback, error, maxRetries, xtreamUrl, timeoutMs, serverUrl, username, password](const cpr::Response& r) {
+        [callback, error, notModified, cached, maxRetries, xtreamUrl, timeoutMs, serverUrl, username, password](const cpr::Response& r) {
             try {
                 brls::Logger::info("Xtream response: status={}, size={}KB", r.status_code, r.text.length()/1024);
                 
@@ -427,9 +284,9 @@ void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(Live
                     brls::Logger::error("Xtream network error: {}", r.error.message);
                     if (maxRetries > 0) {
                         brls::Logger::info("Retrying Xtream request due to network error (retries left: {})", maxRetries - 1);
-                        brls::Threading::async([callback, error, maxRetries]() {
+                        brls::Threading::async([callback, error, maxRetries, notModified]() {
                             std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-                            TsVitchClient::get_xtream_channels_with_retry(callback, error, maxRetries - 1);
+                            TsVitchClient::get_xtream_channels_with_retry(callback, error, maxRetries - 1, notModified);
                         });
                         return;
                     }
@@ -442,13 +299,19 @@ void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(Live
                 // Handle HTTP errors with retry for 503 and 502
                 if ((r.status_code == 503 || r.status_code == 502) && maxRetries > 0) {
                     brls::Logger::warning("Xtream server returned {} - server temporarily unavailable, retrying in 3 seconds (retries left: {})", r.status_code, maxRetries - 1);
-                    brls::Threading::async([callback, error, maxRetries]() {
+                    brls::Threading::async([callback, error, maxRetries, notModified]() {
                         std::this_thread::sleep_for(std::chrono::milliseconds(3000)); // Wait 3 seconds for server errors
-                        TsVitchClient::get_xtream_channels_with_retry(callback, error, maxRetries - 1);
+                        TsVitchClient::get_xtream_channels_with_retry(callback, error, maxRetries - 1, notModified);
                     });
                     return;
                 }
                 
+                if (r.status_code == 304 && notModified) {
+                    brls::Logger::info("Xtream channels not modified (304), keeping cached channels");
+                    brls::sync([notModified]() { notModified(); });
+                    return;
+                }
+
                 if (r.status_code != 200) {
                     brls::Logger::error("Xtream API error: HTTP {}, body: {}", r.status_code, r.text.substr(0, 500));
                     if (error) {
@@ -466,8 +329,18 @@ void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(Live
                 }
                 
                 // Sposta il parsing JSON in un thread asincrono per non bloccare la UI
-                brls::Threading::async([callback, error, responseText = std::move(r.text), serverUrl, username, password]() {
+                brls::Threading::async([callback, error, notModified, cached, xtreamUrl, responseText = std::move(r.text),
+                                        etag = responseHeader(r, "ETag"), lastModified = responseHeader(r, "Last-Modified"),
+                                        serverUrl, username, password]() {
                     try {
+                        // Stesso contenuto della cache: il parsing JSON non serve
+                        auto contentHash = websocketpp::md5::md5_hash_hex(responseText);
+                        if (notModified && !cached.contentHash.empty() && contentHash == cached.contentHash) {
+                            brls::Logger::info("Xtream channels unchanged (same content hash), keeping cached channels");
+                            brls::sync([notModified]() { notModified(); });
+                            return;
+                        }
+
                         auto parse_start = std::chrono::high_resolution_clock::now();
                         
                         nlohmann::json json_result;
@@ -489,7 +362,7 @@ void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(Live
                             return;
                         }
                         
-                        LiveM3u8ListResult result;
+                        ChannelStore result;
                         result.reserve(json_result.size()); // Pre-allocazione per prestazioni
                         
                         size_t processed = 0, skipped = 0;
@@ -538,7 +411,7 @@ void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(Live
                                 
                                 // Only add channels that have required fields
                                 if (!live.id.empty() && !live.title.empty() && !live.url.empty()) {
-                                    result.push_back(std::move(live));
+                                    result.push_back(live);
                                     processed++;
                                 }
                                 
@@ -554,9 +427,12 @@ void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(Live
                         brls::Logger::info("Xtream parsing completed in {}ms - processed: {}, skipped: {}, total: {}", 
                                          parse_duration.count(), processed, skipped, json_result.size());
                         
-                        brls::sync([callback, result = std::move(result)]() {
+                        result.sortByGroup();
+                        ChannelManager::get()->setPendingValidators({xtreamUrl, etag, lastModified, contentHash});
+                        ChannelGroups groups(std::make_shared<const ChannelStore>(std::move(result)));
+                        brls::sync([callback, groups = std::move(groups)]() mutable {
                             if (callback) {
-                                callback(result);
+                                callback(std::move(groups));
                             }
                         });
                         
@@ -579,25 +455,27 @@ void TsVitchClient::get_xtream_channels_with_retry(const std::function<void(Live
         cpr::Url{xtreamUrl},
         cpr::HttpVersion{cpr::HttpVersionCode::VERSION_2_0_TLS},
         cpr::Timeout{timeoutMs},
-        HTTP::HEADERS,
+        HTTP::conditionalHeaders(cached.etag, cached.lastModified),
         HTTP::COOKIES,
         HTTP::PROXIES,
         HTTP::VERIFY);
 }
 
-void TsVitchClient::get_live_channels(const std::function<void(LiveM3u8ListResult)>& callback,
-                                     const ErrorCallback& error) {
+void TsVitchClient::get_live_channels(const std::function<void(ChannelGroups)>& callback,
+                                     const ErrorCallback& error,
+                                     const std::function<void(ChannelGroups)>& preview,
+                                     const std::function<void()>& notModified) {
     // Check IPTV mode and call appropriate function
     int iptvMode = ProgramConfig::instance().getIntOption(SettingItem::IPTV_MODE);
     
     if (iptvMode == 0) {
         // M3U8 Mode
         brls::Logger::debug("Using M3U8 mode for live channels");
-        get_file_m3u8(callback, error);
+        get_file_m3u8(callback, error, preview, notModified);
     } else if (iptvMode == 1) {
         // Xtream Codes Mode
         brls::Logger::debug("Using Xtream mode for live channels");
-        get_xtream_channels(callback, error);
+        get_xtream_channels(callback, error, notModified);
     } else {
         // Unknown mode
         brls::Logger::error("Unknown IPTV mode: {}", iptvMode);
@@ -1,23 +1,371 @@
 #include "core/ChannelManager.hpp"
 #include "utils/config_helper.hpp"
+#include "tsvitch/util/channel_diff.hpp"
+#include "tsvitch/util/mapped_file.hpp"
 #include <fstream>
 #include <filesystem>
 #include <cstdio>
 #include <chrono>
 #include <cstring>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
 #include <thread>
+#include <memory>
+#include <unordered_map>
 
 using json = nlohmann::json;
 
+// Intestazione della cache binaria: va aggiornata ogni volta che cambia il formato.
+// La versione 1 (record di stringhe con lunghezza) viene ancora letta e convertita;
+// dalla 2 il contenuto è l'immagine di ChannelStore, usata direttamente dal file mappato;
+// la 3 la fa precedere dalla directory dei gruppi
+static constexpr char BINARY_CACHE_MAGIC[4]    = {'T', 'S', 'V', 'C'};
+static constexpr uint32_t BINARY_CACHE_VERSION = 3;
+static constexpr uint32_t BINARY_CACHE_IMAGE   = 2;
+// Buffer di scrittura: la memoria usata non dipende dal numero di canali
+static constexpr size_t BINARY_CACHE_WRITE_BUFFER = 256 * 1024;
+
+// Cache per sorgente: al massimo MAX_SOURCE_SLOTS cartelle e SOURCE_SLOTS_BUDGET byte
+// in tutto, eliminando per prime le sorgenti usate meno di recente
+#if defined(__SWITCH__) || defined(__PSV__)
+static constexpr size_t MAX_SOURCE_SLOTS      = 2;
+static constexpr uint64_t SOURCE_SLOTS_BUDGET = 64ULL << 20;
+#else
+static constexpr size_t MAX_SOURCE_SLOTS      = 4;
+static constexpr uint64_t SOURCE_SLOTS_BUDGET = 256ULL << 20;
+#endif
+static constexpr char SOURCE_SLOTS_DIR[] = "channel_cache";
+static constexpr char SLOT_LAST_USED[]   = "last_used.txt";
+
+// I primi tre campi hanno la stessa posizione in tutte le versioni
+struct BinaryCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t checksum;
+    uint64_t payloadSize;
+};
+
+// Directory dei gruppi, all'inizio del contenuto della cache v3: per ogni gruppo
+// l'intervallo dei suoi canali nell'immagine, così da leggerne uno senza leggere gli
+// altri. È vuota se i canali di uno stesso gruppo non sono contigui
+struct GroupDirectoryHeader {
+    uint32_t groups;
+    uint32_t reserved;
+    uint64_t bytes;  // intestazione, voci e nomi, multiplo di 8
+};
+
+struct GroupDirectoryEntry {
+    uint32_t first;
+    uint32_t count;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+
+static std::vector<char> buildGroupDirectory(const tsvitch::ChannelStore& channels) {
+    std::vector<GroupDirectoryEntry> entries;
+    std::string names;
+    std::vector<bool> seen(channels.groupTable().size(), false);
+    for (size_t i = 0; i < channels.size(); ++i) {
+        const uint32_t group = channels.groupId(i);
+        if (!entries.empty() && channels.groupId(entries.back().first) == group) {
+            ++entries.back().count;
+            continue;
+        }
+        if (seen[group]) {
+            entries.clear();
+            names.clear();
+            break;
+        }
+        seen[group]              = true;
+        const std::string& name = channels.group(i);
+        entries.push_back({static_cast<uint32_t>(i), 1, static_cast<uint32_t>(names.size()),
+                           static_cast<uint32_t>(name.size())});
+        names += name;
+    }
+
+    GroupDirectoryHeader header{};
+    header.groups = static_cast<uint32_t>(entries.size());
+    header.bytes  = sizeof(header) + entries.size() * sizeof(GroupDirectoryEntry) + names.size();
+    header.bytes += (8 - header.bytes % 8) % 8;
+
+    std::vector<char> directory(header.bytes, 0);
+    std::memcpy(directory.data(), &header, sizeof(header));
+    if (!entries.empty()) std::memcpy(directory.data() + sizeof(header), entries.data(), entries.size() * sizeof(GroupDirectoryEntry));
+    if (!names.empty())
+        std::memcpy(directory.data() + sizeof(header) + entries.size() * sizeof(GroupDirectoryEntry), names.data(), names.size());
+    return directory;
+}
+
+// Checksum del contenuto della cache: quattro accumulatori indipendenti su parole
+// da 8 byte, così il controllo all'avvio costa poco più della lettura delle pagine
+class CacheChecksum {
+public:
+    void update(const void* data, size_t size) {
+        const char* ptr = static_cast<const char*>(data);
+        if (pendingSize > 0) {
+            size_t take = std::min(size, sizeof(pending) - pendingSize);
+            std::memcpy(pending + pendingSize, ptr, take);
+            pendingSize += take;
+            ptr += take;
+            size -= take;
+            if (pendingSize < sizeof(pending)) return;
+            block(pending);
+            pendingSize = 0;
+        }
+        for (; size >= sizeof(pending); ptr += sizeof(pending), size -= sizeof(pending)) block(ptr);
+        std::memcpy(pending, ptr, size);
+        pendingSize = size;
+    }
+
+    uint32_t value() const {
+        uint64_t hash = total;
+        for (uint64_t lane : lanes) hash = (hash ^ lane) * PRIME;
+        for (size_t i = 0; i < pendingSize; ++i) hash = (hash ^ static_cast<unsigned char>(pending[i])) * PRIME;
+        hash ^= hash >> 29;
+        return static_cast<uint32_t>(hash ^ (hash >> 32));
+    }
+
+private:
+    static constexpr uint64_t PRIME = 0x100000001B3ULL;
+
+    void block(const char* ptr) {
+        for (auto& lane : lanes) {
+            uint64_t word;
+            std::memcpy(&word, ptr, sizeof(word));
+            lane = (lane ^ word) * PRIME;
+            ptr += sizeof(word);
+        }
+        total += sizeof(pending);
+    }
+
+    uint64_t lanes[4] = {0xCBF29CE484222325ULL, 1, 2, 3};
+    uint64_t total    = 0;
+    char pending[32];
+    size_t pendingSize = 0;
+};
+
+// Scrittura a blocchi di dimensione fissa, con il checksum calcolato durante la scrittura
+class CacheWriter {
+public:
+    explicit CacheWriter(std::ofstream& out) : out(out) { buffer.reserve(BINARY_CACHE_WRITE_BUFFER); }
+
+    void write(const void* data, size_t size) {
+        checksum.update(data, size);
+        written += size;
+        if (buffer.size() + size > BINARY_CACHE_WRITE_BUFFER) flush();
+        if (size >= BINARY_CACHE_WRITE_BUFFER) {
+            // Colonne e arena sono già contigue: scritte direttamente, senza copie
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            return;
+        }
+        buffer.insert(buffer.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+    }
+
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    uint64_t written = 0;
+    CacheChecksum checksum;
+
+private:
+    std::ofstream& out;
+    std::vector<char> buffer;
+};
+
+// Ordinamenti salvati accanto alla cache: intestazione, poi byName, byNumber e addedAt
+// (un uint32_t per canale ciascuno). source è l'impronta della lista a cui si riferiscono
+static constexpr char ORDERS_MAGIC[4]    = {'T', 'S', 'V', 'O'};
+static constexpr uint32_t ORDERS_VERSION = 1;
+
+struct OrdersHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t source;
+};
+
+// Journal delle modifiche incrementali, valido solo per la cache binaria di cui
+// riporta dimensione e numero di canali. Ogni segmento ricostruisce la lista
+// nuova dalla precedente con operazioni "copia un intervallo" e "inserisci record"
+static constexpr char JOURNAL_MAGIC[4]    = {'T', 'S', 'V', 'D'};
+static constexpr uint32_t JOURNAL_VERSION = 1;
+static constexpr uint32_t JOURNAL_COPY    = 0;
+static constexpr uint32_t JOURNAL_INSERT  = 1;
+// Oltre questi limiti conviene riscrivere la cache: il journal rallenterebbe il caricamento
+static constexpr uint32_t JOURNAL_MAX_SEGMENTS = 16;
+static constexpr uint64_t JOURNAL_MAX_RATIO    = 4;  // journal fino a 1/4 della cache
+
+struct JournalHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t baseSize;
+    uint32_t baseCount;
+    uint32_t currentCount;
+    uint32_t segments;
+};
+
+static void appendU32(std::vector<char>& buffer, uint32_t value) {
+    const char* ptr = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), ptr, ptr + sizeof(value));
+}
+
+static void appendString(std::vector<char>& buffer, std::string_view str, std::string_view tail = {}) {
+    appendU32(buffer, static_cast<uint32_t>(str.size() + tail.size()));
+    buffer.insert(buffer.end(), str.begin(), str.end());
+    buffer.insert(buffer.end(), tail.begin(), tail.end());
+}
+
+// Stesso formato dei record di LiveM3u8: URL e logo vengono scritti per intero
+static void appendChannel(std::vector<char>& buffer, const tsvitch::ChannelStore& channels, size_t i) {
+    appendString(buffer, channels.id(i));
+    appendString(buffer, channels.chno(i));
+    appendString(buffer, channels.title(i));
+    appendString(buffer, channels.logoPrefix(i), channels.logoTail(i));
+    appendString(buffer, channels.group(i));
+    appendString(buffer, channels.urlPrefix(i), channels.urlTail(i));
+    appendString(buffer, channels.tvgName(i));
+    appendString(buffer, channels.tvgRec(i));
+    appendString(buffer, channels.catchup(i));
+    appendString(buffer, channels.catchupSource(i));
+}
+
 ChannelManager::ChannelManager(const std::filesystem::path& dataDir) : 
     file_{dataDir / "channels.json"},
     binaryFile_{dataDir / "channels.bin"},
-    timestampFile_{dataDir / "channels_timestamp.txt"} {}
+    timestampFile_{dataDir / "channels_timestamp.txt"},
+    metaFile_{dataDir / "channels_meta.json"},
+    journalFile_{dataDir / "channels.journal"},
+    ordersFile_{dataDir / "channels.order"} {}
+
+// Nome della cartella della sorgente: FNV-1a a 64 bit in esadecimale
+static std::string slotName(const std::string& source) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (unsigned char c : source) hash = (hash ^ c) * 0x100000001B3ULL;
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+    return name;
+}
+
+void ChannelManager::updateSettings() {
+    auto& conf         = ProgramConfig::instance();
+    const bool xtream  = conf.getSettingItem(SettingItem::IPTV_MODE, 0) == 1;
+    // La password non fa parte della sorgente: cambiarla non cambia i canali dell'utente
+    std::string source = xtream ? "xtream:" + conf.getXtreamServerUrl() + "|" + conf.getXtreamUsername()
+                                : "m3u8:" + conf.getM3U8Url();
+    hardExpiryMinutes_      = conf.getIntOption(SettingItem::CHANNEL_CACHE_MAX_AGE);
+    revalidateAfterMinutes_ = xtream ? 5 : 15;
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    source_ = std::move(source);
+}
+
+std::string ChannelManager::currentSource() {
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    return source_;
+}
 
 ChannelManager* ChannelManager::get() {
-    const std::string path = ProgramConfig::instance().getConfigDir();
-    static ChannelManager instance(path);
-    return &instance;
+    static std::string active;
+
+    // Niente I/O sulle cartelle qui, get() è chiamato anche dal thread principale: data di
+    // ultimo uso ed eliminazione delle sorgenti vecchie avvengono nel salvataggio
+    const std::string source = currentSource();
+    std::lock_guard<std::mutex> lock(managersMutex_);
+    auto& manager = managers_[source];
+    if (!manager) {
+        const std::filesystem::path configDir = ProgramConfig::instance().getConfigDir();
+        manager             = std::make_unique<ChannelManager>(configDir / SOURCE_SLOTS_DIR / slotName(source));
+        manager->slotsRoot_ = configDir / SOURCE_SLOTS_DIR;
+        // La cache salvata prima delle cartelle per sorgente è di quella configurata all'avvio
+        if (managers_.size() == 1) manager->adoptLegacyCache(configDir);
+    }
+    if (active != source) {
+        brls::Logger::info("ChannelManager: Using cache slot {}", manager->binaryFile_.parent_path().filename().string());
+        active = source;
+    }
+    return manager.get();
+}
+
+void ChannelManager::adoptLegacyCache(const std::filesystem::path& dir) const {
+    std::error_code ec;
+    const bool hasCache = std::filesystem::exists(binaryFile_, ec) || std::filesystem::exists(file_, ec);
+    if (!hasCache) std::filesystem::create_directories(binaryFile_.parent_path(), ec);
+    for (const auto* path : {&file_, &binaryFile_, &timestampFile_, &metaFile_, &journalFile_}) {
+        const auto legacy = dir / path->filename();
+        if (!std::filesystem::exists(legacy, ec)) continue;
+        if (hasCache) {
+            std::filesystem::remove(legacy, ec);
+        } else {
+            brls::Logger::info("ChannelManager: Moving {} to the source cache slot", legacy.filename().string());
+            std::filesystem::rename(legacy, *path, ec);
+        }
+    }
+}
+
+void ChannelManager::markUsed() const {
+    std::error_code ec;
+    std::filesystem::create_directories(binaryFile_.parent_path(), ec);
+    auto now = std::chrono::system_clock::now();
+    std::ofstream(binaryFile_.parent_path() / SLOT_LAST_USED)
+        << std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+}
+
+void ChannelManager::evictSlots() const {
+    if (slotsRoot_.empty()) return;
+
+    struct Slot {
+        std::filesystem::path dir;
+        long long lastUsed;
+        uint64_t bytes;
+    };
+    // Le sorgenti usate in questa sessione hanno un gestore che un task in background può
+    // ancora usare: le loro cartelle non vengono eliminate
+    std::vector<std::filesystem::path> inUse;
+    {
+        std::lock_guard<std::mutex> lock(managersMutex_);
+        for (const auto& [source, manager] : managers_) inUse.push_back(manager->binaryFile_.parent_path());
+    }
+
+    std::vector<Slot> slots;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(slotsRoot_, ec)) {
+        if (!entry.is_directory(ec)) continue;
+        Slot slot{entry.path(), 0, 0};
+        std::ifstream(entry.path() / SLOT_LAST_USED) >> slot.lastUsed;
+        for (const auto& file : std::filesystem::directory_iterator(entry.path(), ec)) {
+            const auto size = file.is_regular_file(ec) ? file.file_size(ec) : 0;
+            if (!ec) slot.bytes += size;
+        }
+        slots.push_back(std::move(slot));
+    }
+    std::sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) { return a.lastUsed > b.lastUsed; });
+
+    // La sorgente in uso non viene mai eliminata e occupa per prima il budget
+    const auto activeDir = binaryFile_.parent_path();
+    size_t kept    = 1;
+    uint64_t total = 0;
+    for (const auto& slot : slots)
+        if (slot.dir == activeDir) total += slot.bytes;
+
+    for (const auto& slot : slots) {
+        if (slot.dir == activeDir) continue;
+        if (std::find(inUse.begin(), inUse.end(), slot.dir) != inUse.end()) {
+            ++kept;
+            total += slot.bytes;
+            continue;
+        }
+        if (kept < MAX_SOURCE_SLOTS && total + slot.bytes <= SOURCE_SLOTS_BUDGET) {
+            ++kept;
+            total += slot.bytes;
+            continue;
+        }
+        brls::Logger::info("ChannelManager: Evicting cache slot {} ({} KB)", slot.dir.filename().string(), slot.bytes / 1024);
+        std::filesystem::remove_all(slot.dir, ec);
+    }
 }
 
 void ChannelManager::save(const tsvitch::LiveM3u8ListResult& channels) const {
@@ -25,7 +373,8 @@ void ChannelManager::save(const tsvitch::LiveM3u8ListResult& channels) const {
     std::ofstream(file_) << j.dump(2);
 }
 
-void ChannelManager::saveWithTimestamp(const tsvitch::LiveM3u8ListResult& channels) const {
+void ChannelManager::saveWithTimestamp(const tsvitch::ChannelStore& channels) const {
+    std::lock_guard<std::mutex> lock(saveMutex_);
     brls::Logger::info("ChannelManager: Starting saveWithTimestamp for {} channels", channels.size());
     brls::Logger::info("ChannelManager: Binary cache file path: {}", binaryFile_.string());
     brls::Logger::info("ChannelManager: Timestamp file path: {}", timestampFile_.string());
@@ -41,24 +390,17 @@ void ChannelManager::saveWithTimestamp(const tsvitch::LiveM3u8ListResult& channe
     brls::Logger::info("ChannelManager: Directory created successfully, saving channels in binary format...");
     
     // Salva i canali in formato binario (molto più veloce del JSON)
-    saveBinary(channels);
-    
-    brls::Logger::info("ChannelManager: Binary cache saved, saving timestamp...");
-    
-    // Salva il timestamp
-    auto now = std::chrono::system_clock::now();
-    auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-    brls::Logger::info("ChannelManager: Saving timestamp: {}", timestamp);
-    
-    std::ofstream timestampStream(timestampFile_);
-    if (!timestampStream) {
-        brls::Logger::error("ChannelManager: Failed to open timestamp file for writing");
+    if (!saveBinary(channels)) {
+        discardMetadata();
         return;
     }
     
-    timestampStream << timestamp;
-    timestampStream.flush();
-    timestampStream.close();
+    brls::Logger::info("ChannelManager: Binary cache saved, saving timestamp...");
+    
+    commitMetadata();
+    // La cache di questa sorgente è cresciuta: le altre potrebbero non starci più
+    markUsed();
+    evictSlots();
     
     brls::Logger::info("ChannelManager: Binary cache and timestamp saved successfully");
     brls::Logger::info("ChannelManager: Verifying files exist...");
@@ -76,7 +418,266 @@ void ChannelManager::saveWithTimestamp(const tsvitch::LiveM3u8ListResult& channe
     }
 }
 
+void ChannelManager::saveDeltaWithTimestamp(const tsvitch::ChannelStore& channels,
+                                            const tsvitch::ChannelDiff& diff) const {
+    std::lock_guard<std::mutex> lock(saveMutex_);
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (diff.empty()) {
+        brls::Logger::info("ChannelManager: No channel changes, refreshing metadata only");
+    } else if (writeJournalSegment(channels, diff)) {
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+        brls::Logger::info("ChannelManager: Journal updated in {}ms (+{} ~{} -{} channels)", duration.count(),
+                           diff.added.size(), diff.changed.size(), diff.removed.size());
+    } else {
+        brls::Logger::info("ChannelManager: Journal not applicable, rewriting the whole binary cache");
+        if (!saveBinary(channels)) {
+            discardMetadata();
+            return;
+        }
+    }
+
+    commitMetadata();
+    markUsed();
+    evictSlots();
+}
+
+void ChannelManager::discardMetadata() const {
+    {
+        std::lock_guard<std::mutex> lock(validatorsMutex_);
+        pendingValidators_ = {};
+    }
+    std::remove(metaFile_.string().c_str());
+}
+
+void ChannelManager::commitMetadata() const {
+    saveTimestamp();
+
+    // Validatori della risposta da cui provengono questi canali; se mancano il
+    // file viene rimosso per non riconvalidare una cache con dati diversi
+    CacheValidators validators;
+    {
+        std::lock_guard<std::mutex> lock(validatorsMutex_);
+        validators = std::move(pendingValidators_);
+        pendingValidators_ = {};
+    }
+    if (validators.empty()) {
+        std::remove(metaFile_.string().c_str());
+    } else {
+        std::ofstream(metaFile_) << json(validators).dump();
+    }
+}
+
+bool ChannelManager::writeJournalSegment(const tsvitch::ChannelStore& channels,
+                                         const tsvitch::ChannelDiff& diff) const {
+    std::error_code ec;
+    const uint64_t baseSize = std::filesystem::file_size(binaryFile_, ec);
+    if (ec) return false;
+
+    JournalHeader header{};
+    const bool fresh = !std::filesystem::exists(journalFile_);
+    if (fresh) {
+        std::ifstream base(binaryFile_, std::ios::binary);
+        BinaryCacheHeader baseHeader{};
+        base.read(reinterpret_cast<char*>(&baseHeader), sizeof(baseHeader));
+        if (!base || std::memcmp(baseHeader.magic, BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC)) != 0 ||
+            baseHeader.version != BINARY_CACHE_VERSION)
+            return false;
+        const uint32_t count = baseHeader.count;
+        std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        header.version      = JOURNAL_VERSION;
+        header.baseSize     = baseSize;
+        header.baseCount    = count;
+        header.currentCount = count;
+    } else {
+        std::ifstream in(journalFile_, std::ios::binary);
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!in || std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+            header.version != JOURNAL_VERSION || header.baseSize != baseSize)
+            return false;
+        if (header.segments >= JOURNAL_MAX_SEGMENTS) return false;
+    }
+
+    // La lista da cui è stato calcolato il diff deve essere quella salvata
+    const size_t previousCount = channels.size() - diff.added.size() + diff.removed.size();
+    if (header.currentCount != previousCount) {
+        brls::Logger::warning("ChannelManager: Journal expects {} channels, diff was computed on {}", header.currentCount,
+                              previousCount);
+        return false;
+    }
+
+    std::vector<bool> isChanged(channels.size(), false);
+    for (size_t j : diff.changed) isChanged[j] = true;
+    auto copyable = [&](size_t j) { return diff.source[j] != tsvitch::ChannelDiff::NONE && !isChanged[j]; };
+
+    std::vector<char> segment;
+    appendU32(segment, static_cast<uint32_t>(previousCount));
+    appendU32(segment, static_cast<uint32_t>(channels.size()));
+    const size_t opCountOffset = segment.size();
+    appendU32(segment, 0);
+
+    uint32_t opCount = 0;
+    for (size_t j = 0; j < channels.size();) {
+        size_t length = 1;
+        if (copyable(j)) {
+            const uint32_t start = diff.source[j];
+            while (j + length < channels.size() && copyable(j + length) && diff.source[j + length] == start + length)
+                ++length;
+            appendU32(segment, JOURNAL_COPY);
+            appendU32(segment, start);
+            appendU32(segment, static_cast<uint32_t>(length));
+        } else {
+            while (j + length < channels.size() && !copyable(j + length)) ++length;
+            appendU32(segment, JOURNAL_INSERT);
+            appendU32(segment, 0);
+            appendU32(segment, static_cast<uint32_t>(length));
+            for (size_t k = j; k < j + length; ++k) appendChannel(segment, channels, k);
+        }
+        ++opCount;
+        j += length;
+    }
+    std::memcpy(segment.data() + opCountOffset, &opCount, sizeof(opCount));
+
+    const uint64_t journalSize = fresh ? sizeof(header) : std::filesystem::file_size(journalFile_, ec);
+    if (ec || journalSize + segment.size() > baseSize / JOURNAL_MAX_RATIO) return false;
+
+    header.currentCount = static_cast<uint32_t>(channels.size());
+    header.segments += 1;
+
+    std::fstream out(journalFile_, fresh ? std::ios::binary | std::ios::out | std::ios::trunc
+                                         : std::ios::binary | std::ios::in | std::ios::out);
+    if (!out) return false;
+    out.seekp(0, fresh ? std::ios::beg : std::ios::end);
+    if (fresh) out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(segment.data(), segment.size());
+    // L'intestazione viene aggiornata per ultima: un segmento scritto a metà resta ignorato
+    out.seekp(0, std::ios::beg);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+    if (!out) {
+        std::remove(journalFile_.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ChannelManager::applyJournal(tsvitch::ChannelStore& channels) const {
+    std::ifstream in(journalFile_, std::ios::binary);
+    if (!in) return true;
+
+    std::error_code ec;
+    JournalHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+        header.version != JOURNAL_VERSION || header.baseSize != std::filesystem::file_size(binaryFile_, ec) ||
+        header.baseCount != channels.size()) {
+        brls::Logger::warning("ChannelManager: Journal does not match the binary cache");
+        return false;
+    }
+
+    // I segmenti vengono prima composti su indici (base o record inseriti) e la
+    // lista finale è costruita con un solo passaggio, qualunque sia il numero di segmenti
+    static constexpr uint32_t INSERTED = 0x80000000u;
+    std::vector<uint32_t> current(channels.size());
+    for (uint32_t i = 0; i < current.size(); ++i) current[i] = i;
+    tsvitch::ChannelStore inserted;
+    tsvitch::LiveM3u8 record;
+
+    for (uint32_t s = 0; s < header.segments; ++s) {
+        uint32_t inputCount = 0, outputCount = 0, opCount = 0;
+        in.read(reinterpret_cast<char*>(&inputCount), sizeof(inputCount));
+        in.read(reinterpret_cast<char*>(&outputCount), sizeof(outputCount));
+        in.read(reinterpret_cast<char*>(&opCount), sizeof(opCount));
+        if (!in || inputCount != current.size() || outputCount > 10000000) return false;
+
+        std::vector<uint32_t> next;
+        next.reserve(outputCount);
+        for (uint32_t o = 0; o < opCount; ++o) {
+            uint32_t op[3] = {};
+            in.read(reinterpret_cast<char*>(op), sizeof(op));
+            const uint32_t kind = op[0], start = op[1], count = op[2];
+            if (!in || next.size() + count > outputCount) return false;
+            if (kind == JOURNAL_COPY) {
+                if (static_cast<size_t>(start) + count > current.size()) return false;
+                next.insert(next.end(), current.begin() + start, current.begin() + start + count);
+            } else if (kind == JOURNAL_INSERT) {
+                for (uint32_t k = 0; k < count; ++k) {
+                    next.push_back(INSERTED | static_cast<uint32_t>(inserted.size()));
+                    readChannel(in, record);
+                    inserted.push_back(record);
+                }
+                if (!in) return false;
+            } else {
+                return false;
+            }
+        }
+        if (next.size() != outputCount) return false;
+        current = std::move(next);
+    }
+
+    if (current.size() != header.currentCount) return false;
+
+    tsvitch::ChannelStore result;
+    result.reserve(current.size());
+    for (uint32_t index : current) {
+        if (index & INSERTED)
+            result.push_back(inserted, index & ~INSERTED);
+        else
+            result.push_back(channels, index);
+    }
+    channels = std::move(result);
+
+    brls::Logger::info("ChannelManager: Applied {} journal segments ({} channels)", header.segments, channels.size());
+    return true;
+}
+
+void ChannelManager::saveTimestamp() const {
+    auto now = std::chrono::system_clock::now();
+    auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+    brls::Logger::info("ChannelManager: Saving timestamp: {}", timestamp);
+    
+    std::ofstream timestampStream(timestampFile_);
+    if (!timestampStream) {
+        brls::Logger::error("ChannelManager: Failed to open timestamp file for writing");
+        return;
+    }
+    
+    timestampStream << timestamp;
+    timestampStream.flush();
+}
+
+void ChannelManager::touchTimestamp() const {
+    brls::Logger::info("ChannelManager: Source not modified, refreshing cache timestamp");
+    saveTimestamp();
+}
+
+CacheValidators ChannelManager::loadValidators(const std::string& source) const {
+    // Senza cache binaria i validatori non servono: bisogna comunque scaricare tutto
+    if (!std::filesystem::exists(binaryFile_)) return {};
+    try {
+        std::ifstream in(metaFile_);
+        if (!in) return {};
+        CacheValidators validators = json::parse(in).get<CacheValidators>();
+        if (validators.source != source) return {};
+        return validators;
+    } catch (const std::exception& e) {
+        brls::Logger::warning("ChannelManager: Invalid cache metadata: {}", e.what());
+        return {};
+    }
+}
+
+void ChannelManager::setPendingValidators(const CacheValidators& validators) const {
+    std::lock_guard<std::mutex> lock(validatorsMutex_);
+    pendingValidators_ = validators;
+}
+
+int ChannelManager::hardExpiryMinutes() { return hardExpiryMinutes_; }
+
+int ChannelManager::revalidateAfterMinutes() { return revalidateAfterMinutes_; }
+
 bool ChannelManager::isCacheValid(int maxAgeMinutes) const {
+    if (maxAgeMinutes < 0) maxAgeMinutes = hardExpiryMinutes();
+
     brls::Logger::debug("ChannelManager: Checking cache validity...");
     brls::Logger::debug("ChannelManager: Binary cache file path: {}", binaryFile_.string());
     brls::Logger::debug("ChannelManager: Timestamp file path: {}", timestampFile_.string());
@@ -126,20 +727,21 @@ bool ChannelManager::isCacheValid(int maxAgeMinutes) const {
     return isValid;
 }
 
-tsvitch::LiveM3u8ListResult ChannelManager::loadIfValid(int maxAgeMinutes) const {
+tsvitch::ChannelStore ChannelManager::loadIfValid(int maxAgeMinutes) const {
+    if (maxAgeMinutes < 0) maxAgeMinutes = hardExpiryMinutes();
     brls::Logger::debug("ChannelManager: Attempting to load valid cache (max age: {} minutes)", maxAgeMinutes);
     
     if (isCacheValid(maxAgeMinutes)) {
         brls::Logger::debug("ChannelManager: Cache is valid, loading channels");
         
         // Preferisce la cache binaria se esiste, altrimenti fallback a JSON
-        tsvitch::LiveM3u8ListResult result;
+        tsvitch::ChannelStore result;
         if (std::filesystem::exists(binaryFile_)) {
             brls::Logger::debug("ChannelManager: Loading from binary cache (fast)");
             result = loadBinary();
         } else {
             brls::Logger::debug("ChannelManager: Loading from JSON cache (slow, will convert to binary)");
-            result = load();
+            result = tsvitch::ChannelStore::fromList(load());
             // Converti a formato binario per il prossimo caricamento
             if (!result.empty()) {
                 brls::Logger::info("ChannelManager: Converting JSON cache to binary format for faster future loads");
@@ -159,6 +761,81 @@ void ChannelManager::remove() const {
     std::remove(file_.string().c_str());
     std::remove(binaryFile_.string().c_str());
     std::remove(timestampFile_.string().c_str());
+    std::remove(metaFile_.string().c_str());
+    std::remove(journalFile_.string().c_str());
+    std::remove(ordersFile_.string().c_str());
+}
+
+void ChannelManager::saveOrders(const tsvitch::ChannelOrders& orders) const {
+    std::lock_guard<std::mutex> lock(saveMutex_);
+    std::error_code ec;
+    std::filesystem::create_directories(ordersFile_.parent_path(), ec);
+
+    const std::filesystem::path tempFile = ordersFile_.string() + ".tmp";
+    {
+        std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+        OrdersHeader header{};
+        std::memcpy(header.magic, ORDERS_MAGIC, sizeof(ORDERS_MAGIC));
+        header.version = ORDERS_VERSION;
+        header.count   = static_cast<uint32_t>(orders.byName.size());
+        header.source  = orders.source;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto* column : {&orders.byName, &orders.byNumber, &orders.addedAt})
+            out.write(reinterpret_cast<const char*>(column->data()),
+                      static_cast<std::streamsize>(column->size() * sizeof(uint32_t)));
+        if (!out) {
+            brls::Logger::error("ChannelManager: Failed to write channel orders");
+            out.close();
+            std::remove(tempFile.string().c_str());
+            return;
+        }
+    }
+    std::filesystem::rename(tempFile, ordersFile_, ec);
+    if (ec) {
+        brls::Logger::error("ChannelManager: Failed to replace channel orders: {}", ec.message());
+        std::remove(tempFile.string().c_str());
+    }
+}
+
+std::shared_ptr<const tsvitch::ChannelOrders> ChannelManager::loadOrders(const tsvitch::ChannelStore& channels) const {
+    if (channels.empty()) return nullptr;
+    auto start  = std::chrono::high_resolution_clock::now();
+    auto orders = std::make_shared<tsvitch::ChannelOrders>();
+
+    std::ifstream in(ordersFile_, std::ios::binary);
+    OrdersHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    bool valid = in && std::memcmp(header.magic, ORDERS_MAGIC, sizeof(ORDERS_MAGIC)) == 0 &&
+                 header.version == ORDERS_VERSION && header.count == channels.size();
+    if (valid) {
+        for (auto* column : {&orders->byName, &orders->byNumber, &orders->addedAt}) {
+            column->resize(header.count);
+            in.read(reinterpret_cast<char*>(column->data()), static_cast<std::streamsize>(header.count * sizeof(uint32_t)));
+        }
+        orders->source = header.source;
+        // Le permutazioni vengono usate come indici e per distribuire i canali nei gruppi: ogni
+        // indice deve comparire una volta sola, o un file danneggiato scriverebbe fuori dai gruppi
+        auto isPermutation = [&header](const std::vector<uint32_t>& column) {
+            std::vector<bool> seen(header.count, false);
+            for (uint32_t index : column) {
+                if (index >= header.count || seen[index]) return false;
+                seen[index] = true;
+            }
+            return true;
+        };
+        valid = in && isPermutation(orders->byName) && isPermutation(orders->byNumber) && orders->matches(channels);
+    }
+
+    if (!valid) {
+        brls::Logger::info("ChannelManager: No channel orders for this list, computing them");
+        const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        *orders = tsvitch::ChannelOrders::compute(channels, static_cast<uint32_t>(now));
+        saveOrders(*orders);
+    }
+    brls::Logger::info("ChannelManager: Channel orders {} in {}ms", valid ? "loaded" : "computed",
+                       std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count());
+    return orders;
 }
 
 tsvitch::LiveM3u8ListResult ChannelManager::load() const {
@@ -195,7 +872,12 @@ void ChannelManager::writeString(std::ofstream& out, const std::string& str) con
 std::string ChannelManager::readString(std::ifstream& in) const {
     uint32_t length = 0;
     in.read(reinterpret_cast<char*>(&length), sizeof(length));
-    if (length == 0) {
+    if (!in || length == 0) {
+        return "";
+    }
+    // Una stringa troncata o corrotta non deve causare allocazioni enormi
+    if (length > (1u << 24)) {
+        in.setstate(std::ios::failbit);
         return "";
     }
     std::string str(length, '\0');
@@ -203,109 +885,279 @@ std::string ChannelManager::readString(std::ifstream& in) const {
     return str;
 }
 
-// Serializzazione binaria veloce (10-20x più veloce del JSON)
-void ChannelManager::saveBinary(const tsvitch::LiveM3u8ListResult& channels) const {
-    try {
-        std::ofstream out(binaryFile_, std::ios::binary);
-        if (!out) {
-            brls::Logger::error("ChannelManager: Failed to open binary cache file for writing");
+void ChannelManager::readChannel(std::ifstream& in, tsvitch::LiveM3u8& channel) const {
+    for (auto* field : {&channel.id, &channel.chno, &channel.title, &channel.logo, &channel.groupTitle, &channel.url,
+                        &channel.tvgName, &channel.tvgRec, &channel.catchup, &channel.catchupSource}) {
+        uint32_t length = 0;
+        in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        // Un record troncato o corrotto non deve causare allocazioni enormi
+        if (!in || length > (1u << 24)) {
+            in.setstate(std::ios::failbit);
             return;
         }
-        
+        field->resize(length);
+        if (length > 0) in.read(&(*field)[0], length);
+    }
+}
+
+// Immagine di ChannelStore scritta a blocchi in un file temporaneo, che sostituisce
+// la cache solo quando è completa: un'interruzione lascia intatta quella precedente
+bool ChannelManager::saveBinary(const tsvitch::ChannelStore& channels) const {
+    const std::filesystem::path tempFile = binaryFile_.string() + ".tmp";
+    try {
         auto write_start = std::chrono::high_resolution_clock::now();
-        
-        // Scrivi il numero di canali
-        uint32_t count = static_cast<uint32_t>(channels.size());
-        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
-        
-        // Buffer per accumulate dati prima di scrivere (riduce syscall da 3.6M a ~60k)
-        std::vector<char> buffer;
-        buffer.reserve(300 * 1024 * 1024); // Pre-alloca 300MB per evitare reallocazioni
-        
-        // Scrivi ogni canale nel buffer
-        for (size_t i = 0; i < channels.size(); ++i) {
-            const auto& channel = channels[i];
-            
-            // Scrivi nel buffer anziché nel file
-            auto appendString = [&buffer](const std::string& str) {
-                uint32_t length = static_cast<uint32_t>(str.size());
-                const char* lenPtr = reinterpret_cast<const char*>(&length);
-                buffer.insert(buffer.end(), lenPtr, lenPtr + sizeof(length));
-                if (length > 0) {
-                    buffer.insert(buffer.end(), str.begin(), str.end());
-                }
-            };
-            
-            appendString(channel.id);
-            appendString(channel.chno);
-            appendString(channel.title);
-            appendString(channel.logo);
-            appendString(channel.groupTitle);
-            appendString(channel.url);
-            
-            // Scrivi il buffer al file ogni 5000 canali per non usare troppa RAM
-            if ((i + 1) % 5000 == 0) {
-                out.write(buffer.data(), buffer.size());
-                buffer.clear();
-                out.flush();
-                std::this_thread::yield();
-                brls::Logger::debug("ChannelManager: Written {} channels so far...", i + 1);
+        {
+            std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                brls::Logger::error("ChannelManager: Failed to open binary cache file for writing");
+                return false;
+            }
+
+            // Intestazione provvisoria, completata con dimensione e checksum alla fine
+            BinaryCacheHeader header{};
+            std::memcpy(header.magic, BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC));
+            header.version = BINARY_CACHE_VERSION;
+            header.count   = static_cast<uint32_t>(channels.size());
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            CacheWriter writer(out);
+            const std::vector<char> directory = buildGroupDirectory(channels);
+            writer.write(directory.data(), directory.size());
+            channels.serialize([&writer](const void* data, size_t size) { writer.write(data, size); });
+            writer.flush();
+
+            header.checksum    = writer.checksum.value();
+            header.payloadSize = writer.written;
+            out.seekp(0);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.flush();
+            if (!out) {
+                brls::Logger::error("ChannelManager: Failed to write binary cache");
+                out.close();
+                std::remove(tempFile.string().c_str());
+                return false;
             }
         }
-        
-        // Scrivi i dati rimasti nel buffer
-        if (!buffer.empty()) {
-            out.write(buffer.data(), buffer.size());
+
+        std::error_code ec;
+        std::filesystem::rename(tempFile, binaryFile_, ec);
+        if (ec) {
+            // Restano la cache precedente e il suo journal, ancora coerenti tra loro
+            brls::Logger::error("ChannelManager: Failed to replace binary cache: {}", ec.message());
+            std::remove(tempFile.string().c_str());
+            return false;
         }
-        
-        out.flush();
-        out.close();
-        
+        // Solo ora: il journal si riferiva alla cache appena sostituita
+        std::remove(journalFile_.string().c_str());
+
         auto write_end = std::chrono::high_resolution_clock::now();
         auto write_duration = std::chrono::duration_cast<std::chrono::milliseconds>(write_end - write_start);
-        brls::Logger::info("ChannelManager: Binary cache saved successfully ({} channels in {}ms)", count, write_duration.count());
+        brls::Logger::info("ChannelManager: Binary cache saved successfully ({} channels in {}ms)", channels.size(),
+                           write_duration.count());
+        return true;
     } catch (const std::exception& e) {
         brls::Logger::error("ChannelManager: Error saving binary cache: {}", e.what());
+        std::remove(tempFile.string().c_str());
+        return false;
     }
 }
 
-// Deserializzazione binaria veloce (10-20x più veloce del JSON)
-tsvitch::LiveM3u8ListResult ChannelManager::loadBinary() const {
-    tsvitch::LiveM3u8ListResult channels;
+// Cache v2: colonne e testo vengono usati direttamente dal file mappato, senza
+// leggere né allocare i singoli canali; restano solo il controllo del checksum
+// e quello degli intervalli
+tsvitch::ChannelStore ChannelManager::loadBinary() const {
+    tsvitch::ChannelStore channels;
     try {
-        std::ifstream in(binaryFile_, std::ios::binary);
-        if (!in) {
+        auto load_start = std::chrono::high_resolution_clock::now();
+        auto file       = tsvitch::MappedFile::open(binaryFile_.string());
+        if (!file) {
             brls::Logger::debug("ChannelManager: Could not open binary cache file");
             return channels;
         }
-        
-        // Leggi il numero di canali
-        uint32_t count = 0;
-        in.read(reinterpret_cast<char*>(&count), sizeof(count));
-        
-        if (count == 0 || count > 10000000) { // Sanity check
-            brls::Logger::error("ChannelManager: Invalid channel count in binary cache: {}", count);
+
+        BinaryCacheHeader header{};
+        if (file->size() < sizeof(BINARY_CACHE_MAGIC) ||
+            std::memcmp(file->data(), BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC)) != 0) {
+            file.reset();
+            return loadLegacyBinary();
+        }
+        if (file->size() < sizeof(header)) {
+            brls::Logger::info("ChannelManager: Binary cache is truncated, ignoring it");
             return channels;
         }
-        
-        channels.reserve(count);
-        
-        // Leggi ogni canale
-        for (uint32_t i = 0; i < count; ++i) {
-            tsvitch::LiveM3u8 channel;
-            channel.id = readString(in);
-            channel.chno = readString(in);
-            channel.title = readString(in);
-            channel.logo = readString(in);
-            channel.groupTitle = readString(in);
-            channel.url = readString(in);
-            channels.push_back(std::move(channel));
+        std::memcpy(&header, file->data(), sizeof(header));
+
+        // Le cache scritte con un formato diverso vengono ignorate e riscaricate
+        if (header.version != BINARY_CACHE_VERSION && header.version != BINARY_CACHE_IMAGE) {
+            brls::Logger::info("ChannelManager: Binary cache has an old format, ignoring it");
+            return channels;
         }
-        
-        brls::Logger::info("ChannelManager: Binary cache loaded successfully ({} channels)", channels.size());
+
+        const char* payload = file->data() + sizeof(header);
+        if (header.payloadSize != file->size() - sizeof(header)) {
+            brls::Logger::error("ChannelManager: Binary cache is truncated ({} of {} bytes)", file->size() - sizeof(header),
+                                header.payloadSize);
+            return channels;
+        }
+        CacheChecksum checksum;
+        checksum.update(payload, header.payloadSize);
+        if (checksum.value() != header.checksum) {
+            brls::Logger::error("ChannelManager: Binary cache checksum mismatch, ignoring it");
+            return channels;
+        }
+        // Nella v3 l'immagine segue la directory dei gruppi
+        uint64_t directoryBytes = 0;
+        if (header.version == BINARY_CACHE_VERSION) {
+            GroupDirectoryHeader directory{};
+            if (header.payloadSize >= sizeof(directory)) std::memcpy(&directory, payload, sizeof(directory));
+            directoryBytes = directory.bytes;
+            if (directoryBytes < sizeof(directory) || directoryBytes > header.payloadSize || directoryBytes % 8 != 0) {
+                brls::Logger::error("ChannelManager: Binary cache has an invalid group directory, ignoring it");
+                return channels;
+            }
+        }
+        if (!tsvitch::ChannelStore::deserialize(file, sizeof(header) + directoryBytes, header.payloadSize - directoryBytes,
+                                                channels) ||
+            channels.size() != header.count) {
+            brls::Logger::error("ChannelManager: Binary cache is inconsistent, ignoring it");
+            return {};
+        }
+
+        // Modifiche incrementali salvate dopo la cache: se non sono applicabili la
+        // cache non rappresenta più la sorgente e va riscaricata
+        const bool hasJournal = std::filesystem::exists(journalFile_);
+        if (!applyJournal(channels)) {
+            brls::Logger::error("ChannelManager: Channel journal is corrupted, discarding the cache");
+            remove();
+            return {};
+        }
+        // Con il journal la directory non descrive più i canali: la cache viene riscritta
+        // (siamo già in background) così il prossimo avvio può leggere un gruppo alla volta
+        if (hasJournal) {
+            std::lock_guard<std::mutex> lock(saveMutex_);
+            saveBinary(channels);
+        }
+
+        auto load_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - load_start);
+        brls::Logger::info("ChannelManager: Binary cache loaded in {}ms ({} channels, {} KB {}, {} KB in memory)",
+                           load_duration.count(), channels.size(), file->size() / 1024,
+                           file->mapped() ? "mapped" : "read", channels.memoryUsage() / 1024);
     } catch (const std::exception& e) {
         brls::Logger::error("ChannelManager: Error loading binary cache: {}", e.what());
-        channels.clear();
+        channels = {};
+    }
+    return channels;
+}
+
+std::vector<ChannelManager::CachedGroup> ChannelManager::loadGroupIndexIfValid(int maxAgeMinutes) const {
+    // Il journal modifica canali già elencati nella directory: in quel caso si legge tutto
+    if (!isCacheValid(maxAgeMinutes) || std::filesystem::exists(journalFile_)) return {};
+
+    std::ifstream in(binaryFile_, std::ios::binary);
+    BinaryCacheHeader header{};
+    GroupDirectoryHeader directory{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    in.read(reinterpret_cast<char*>(&directory), sizeof(directory));
+    if (!in || std::memcmp(header.magic, BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC)) != 0 ||
+        header.version != BINARY_CACHE_VERSION || directory.groups == 0 || directory.bytes > header.payloadSize ||
+        uint64_t(directory.groups) * sizeof(GroupDirectoryEntry) > directory.bytes - sizeof(directory))
+        return {};
+
+    std::vector<GroupDirectoryEntry> entries(directory.groups);
+    std::string names(directory.bytes - sizeof(directory) - entries.size() * sizeof(GroupDirectoryEntry), '\0');
+    in.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(GroupDirectoryEntry));
+    in.read(names.data(), names.size());
+    if (!in) return {};
+
+    std::vector<CachedGroup> groups;
+    groups.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (entry.nameOffset > names.size() || entry.nameLength > names.size() - entry.nameOffset ||
+            entry.first > header.count || entry.count > header.count - entry.first)
+            return {};
+        groups.push_back({names.substr(entry.nameOffset, entry.nameLength), entry.first, entry.count});
+    }
+    brls::Logger::debug("ChannelManager: Group directory loaded ({} groups, {} channels)", groups.size(), header.count);
+    return groups;
+}
+
+tsvitch::ChannelStore ChannelManager::loadGroups(const std::vector<CachedGroup>& groups) const {
+    tsvitch::ChannelStore channels;
+    auto load_start = std::chrono::high_resolution_clock::now();
+
+    std::ifstream in(binaryFile_, std::ios::binary);
+    BinaryCacheHeader header{};
+    GroupDirectoryHeader directory{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    in.read(reinterpret_cast<char*>(&directory), sizeof(directory));
+    if (!in || header.version != BINARY_CACHE_VERSION || directory.bytes > header.payloadSize) return channels;
+
+    // Solo le parti delle colonne e dell'arena dei gruppi richiesti, senza checksum:
+    // gli intervalli vengono comunque controllati e il caricamento completo lo verifica
+    const uint64_t image = sizeof(header) + directory.bytes;
+    const uint64_t limit = header.payloadSize - directory.bytes;
+    auto read = [&in, image, limit](uint64_t offset, void* data, size_t size) {
+        if (offset > limit || size > limit - offset) return false;
+        if (size == 0) return true;
+        in.seekg(static_cast<std::streamoff>(image + offset));
+        in.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        return static_cast<bool>(in);
+    };
+    for (const auto& group : groups) {
+        if (!tsvitch::ChannelStore::readRange(read, group.first, group.count, channels)) {
+            brls::Logger::error("ChannelManager: Could not read group \"{}\" from the binary cache", group.name);
+            return {};
+        }
+    }
+
+    auto load_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - load_start);
+    brls::Logger::info("ChannelManager: {} groups loaded from the binary cache in {}ms ({} channels)", groups.size(),
+                       load_duration.count(), channels.size());
+    return channels;
+}
+
+// Cache delle versioni senza intestazione: numero di canali seguito da id, chno, title, logo,
+// groupTitle e url di ogni canale. Letta una sola volta e riscritta nel formato attuale
+tsvitch::ChannelStore ChannelManager::loadLegacyBinary() const {
+    std::ifstream in(binaryFile_, std::ios::binary | std::ios::ate);
+    const std::streamoff size = in.tellg();
+    in.seekg(0);
+
+    // Il magic letto come numero di canali supera il limite: nessuna ambiguità col formato attuale
+    uint32_t count = 0;
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || count == 0 || count > 10000000) {  // Sanity check
+        brls::Logger::info("ChannelManager: Binary cache has an unknown format, ignoring it");
+        return {};
+    }
+
+    tsvitch::ChannelStore channels;
+    channels.reserve(count);
+    tsvitch::LiveM3u8 channel;
+    for (uint32_t i = 0; i < count; ++i) {
+        channel.id         = readString(in);
+        channel.chno       = readString(in);
+        channel.title      = readString(in);
+        channel.logo       = readString(in);
+        channel.groupTitle = readString(in);
+        channel.url        = readString(in);
+        if (!in) {
+            brls::Logger::error("ChannelManager: Binary cache is truncated at channel {}", i);
+            return {};
+        }
+        channels.push_back(channel);
+    }
+    // Byte in avanzo: il file non è una cache di quel formato
+    if (in.tellg() != size) {
+        brls::Logger::info("ChannelManager: Binary cache has an unknown format, ignoring it");
+        return {};
     }
+    in.close();
+
+    brls::Logger::info("ChannelManager: Converting {} channels to binary cache v{}", channels.size(), BINARY_CACHE_VERSION);
+    std::lock_guard<std::mutex> lock(saveMutex_);
+    saveBinary(channels);
     return channels;
 }
\ No newline at end of file
@@ -1,12 +1,16 @@
 #include "core/HistoryManager.hpp"
 #include "utils/config_helper.hpp"
+#include <borealis/core/thread.hpp>
 #include <fstream>
 #include <filesystem>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
-HistoryManager::HistoryManager(const std::filesystem::path& dataDir) : file_{dataDir / "history.json"} { load(); }
+HistoryManager::HistoryManager(const std::filesystem::path& dataDir)
+    : file_{dataDir / "history.json"}, countsFile_{dataDir / "watch_counts.json"} {
+    load();
+}
 
 HistoryManager* HistoryManager::get() {
     const std::string path = ProgramConfig::instance().getConfigDir();
@@ -24,7 +28,18 @@ void HistoryManager::add(const tsvitch::LiveM3u8& channel) {
     ring_.push_front(channel);
     // Mantieni solo MAX_ITEMS elementi
     while (ring_.size() > MAX_ITEMS) ring_.pop_back();
-    save();
+    {
+        std::lock_guard<std::mutex> lock(countsMutex_);
+        ++counts_[tsvitch::watchKey(channel.url)];
+    }
+    json j = ring_;
+    std::ofstream(file_) << j.dump(2);
+    scheduleCountsSave();
+}
+
+tsvitch::WatchCounts HistoryManager::watchCounts() const {
+    std::lock_guard<std::mutex> lock(countsMutex_);
+    return counts_;
 }
 
 std::deque<tsvitch::LiveM3u8> HistoryManager::recent(std::size_t limit) const {
@@ -34,6 +49,38 @@ std::deque<tsvitch::LiveM3u8> HistoryManager::recent(std::size_t limit) const {
 void HistoryManager::save() const {
     json j = ring_;
     std::ofstream(file_) << j.dump(2);
+    saveCounts();
+}
+
+void HistoryManager::scheduleCountsSave() const {
+    // Una sola scrittura in attesa: comprende anche i canali aperti nel frattempo
+    if (countsSaveQueued_.exchange(true)) return;
+    brls::Threading::async([this]() { saveCounts(); });
+}
+
+void HistoryManager::saveCounts() const {
+    countsSaveQueued_ = false;
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(countsMutex_);
+        text = json(counts_).dump();
+    }
+    // File temporaneo rinominato: un'uscita durante la scrittura non lascia un file a metà
+    std::lock_guard<std::mutex> lock(countsFileMutex_);
+    const std::filesystem::path tempFile = countsFile_.string() + ".tmp";
+    {
+        std::ofstream out(tempFile, std::ios::trunc);
+        out << text;
+        if (!out) {
+            brls::Logger::error("HistoryManager: Failed to write watch counts");
+            out.close();
+            std::remove(tempFile.string().c_str());
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempFile, countsFile_, ec);
+    if (ec) std::remove(tempFile.string().c_str());
 }
 
 void HistoryManager::load() {
@@ -44,4 +91,18 @@ void HistoryManager::load() {
         // Se il file contiene più di MAX_ITEMS, tronca la coda
         while (ring_.size() > MAX_ITEMS) ring_.pop_back();
     }
+    // Coppie [chiave dell'URL, visualizzazioni]
+    if (std::ifstream in{countsFile_}; in) {
+        try {
+            json j = json::parse(in, nullptr, false);
+            if (j.is_array()) {
+                auto counts = j.get<tsvitch::WatchCounts>();
+                std::lock_guard<std::mutex> lock(countsMutex_);
+                counts_ = std::move(counts);
+            }
+        } catch (const std::exception& e) {
+            // Conteggi danneggiati: si riparte da zero invece di fermare l'avvio
+            brls::Logger::error("HistoryManager: Invalid watch counts, starting empty: {}", e.what());
+        }
+    }
 }
@@ -0,0 +1,305 @@
+#include "core/ImageCache.hpp"
+#include "utils/config_helper.hpp"
+#include "tsvitch/util/md5.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+using json = nlohmann::json;
+
+static int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// Scadenza secondo Cache-Control; negativa se la risposta non va salvata
+static int64_t expiresAt(std::string cacheControl, int64_t now) {
+    std::transform(cacheControl.begin(), cacheControl.end(), cacheControl.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (cacheControl.find("no-store") != std::string::npos) return -1;
+    if (cacheControl.find("no-cache") != std::string::npos) return now;
+    auto pos = cacheControl.find("max-age=");
+    if (pos == std::string::npos) return now + ImageCache::DEFAULT_MAX_AGE;
+    int64_t maxAge = 0;
+    for (pos += 8; pos < cacheControl.size() && std::isdigit(static_cast<unsigned char>(cacheControl[pos])); ++pos)
+        maxAge = std::min<int64_t>(maxAge * 10 + (cacheControl[pos] - '0'), 10LL * 365 * 24 * 3600);
+    return now + maxAge;
+}
+
+ImageCache::ImageCache(const std::filesystem::path& dir)
+    : dir_{dir}, blobsDir_{dir / "blobs"}, indexFile_{dir / "index.json"} {
+    load();
+}
+
+ImageCache::~ImageCache() { saveIndex(true); }
+
+ImageCache* ImageCache::get() {
+    static ImageCache instance(std::filesystem::path(ProgramConfig::instance().getConfigDir()) / "images");
+    return &instance;
+}
+
+void ImageCache::load() {
+    auto start = std::chrono::high_resolution_clock::now();
+    std::error_code ec;
+    std::filesystem::create_directories(blobsDir_, ec);
+
+    std::ifstream in(indexFile_);
+    if (in) {
+        try {
+            json j;
+            in >> j;
+            for (auto& item : j) {
+                auto entry = item.get<ImageCacheEntry>();
+                if (entry.url.empty() || entry.hash.empty()) continue;
+                auto& blob = blobs_[entry.hash];
+                if (blob.refs++ == 0) {
+                    blob.size = entry.size;
+                    totalBytes_ += entry.size;
+                }
+                entries_[entry.url] = std::move(entry);
+            }
+        } catch (const std::exception& e) {
+            brls::Logger::error("ImageCache: Invalid index, starting empty: {}", e.what());
+            entries_.clear();
+            blobs_.clear();
+            totalBytes_ = 0;
+        }
+    }
+
+    // File scritti dopo l'ultimo salvataggio dell'indice (o temporanei rimasti a metà): nessuno li userà
+    size_t removed = 0;
+    for (auto it = std::filesystem::directory_iterator(blobsDir_, ec); !ec && it != std::filesystem::directory_iterator();
+         it.increment(ec)) {
+        if (blobs_.count(it->path().filename().string())) continue;
+        std::filesystem::remove(it->path(), ec);
+        ++removed;
+    }
+
+    brls::Logger::info("ImageCache: {} images ({} KB) in {}ms, {} stray files removed", entries_.size(),
+                       totalBytes_ / 1024,
+                       std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::high_resolution_clock::now() - start)
+                           .count(),
+                       removed);
+}
+
+std::optional<ImageCache::Hit> ImageCache::find(const std::string& url) {
+    if (MAX_SIZE_MB == 0) return std::nullopt;
+    const int64_t now = nowSeconds();
+    Hit hit;
+    std::string hash;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it == entries_.end()) return std::nullopt;
+        it->second.lastUsed = now;
+        dirty_              = true;
+        hash                = it->second.hash;
+        hit.stale           = now >= it->second.expires;
+        hit.etag            = it->second.etag;
+        hit.lastModified    = it->second.lastModified;
+    }
+
+    // I file non cambiano mai dopo la scrittura: si leggono senza bloccare gli altri thread
+    std::ifstream in(blobPath(hash), std::ios::binary | std::ios::ate);
+    std::streamsize size = in ? static_cast<std::streamsize>(in.tellg()) : 0;
+    if (size > 0) {
+        hit.data.resize(static_cast<size_t>(size));
+        in.seekg(0);
+        in.read(hit.data.data(), size);
+    }
+    if (size <= 0 || !in) {
+        // Eliminato nel frattempo per far posto ad altre immagini
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it != entries_.end() && it->second.hash == hash) erase(it);
+        return std::nullopt;
+    }
+    saveIndex(false);
+    return hit;
+}
+
+void ImageCache::store(const std::string& url, const std::string& data, const ImageCacheHeaders& headers) {
+    if (MAX_SIZE_MB == 0 || data.empty()) return;
+    const int64_t now     = nowSeconds();
+    const int64_t expires = expiresAt(headers.cacheControl, now);
+    if (expires < 0) {
+        remove(url);
+        return;
+    }
+
+    const std::string hash = websocketpp::md5::md5_hash_hex(data);
+    // Il file si scrive senza lucchetto: un trim o un erase di un altro thread può eliminarlo
+    // prima della registrazione, che quindi avviene solo dopo aver ricontrollato sotto il
+    // lucchetto che il blob sia ancora nell'indice o che il file appena scritto esista
+    for (int attempt = 0;; ++attempt) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::error_code ec;
+            if (blobs_.count(hash) > 0 || (attempt > 0 && std::filesystem::exists(blobPath(hash), ec))) {
+                addEntry(url, hash, data.size(), expires, now, headers);
+                break;
+            }
+        }
+        if (attempt == 2 || !writeBlob(hash, data)) {
+            brls::Logger::warning("ImageCache: Failed to write {}", url);
+            return;
+        }
+    }
+    saveIndex(false);
+}
+
+bool ImageCache::writeBlob(const std::string& hash, const std::string& data) {
+    // Nome temporaneo diverso per ogni scrittura: più thread possono salvare la stessa immagine
+    static std::atomic<uint32_t> counter{0};
+    const std::filesystem::path tempFile = blobPath(hash).string() + ".tmp" + std::to_string(++counter);
+    {
+        std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            out.close();
+            std::remove(tempFile.string().c_str());
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempFile, blobPath(hash), ec);
+    if (ec) {
+        std::remove(tempFile.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+void ImageCache::addEntry(const std::string& url, const std::string& hash, uint64_t size, int64_t expires,
+                          int64_t now, const ImageCacheHeaders& headers) {
+    auto it = entries_.find(url);
+    if (it != entries_.end() && it->second.hash != hash) {
+        erase(it);
+        it = entries_.end();
+    }
+    if (it == entries_.end()) {
+        auto& blob = blobs_[hash];
+        if (blob.refs++ == 0) {
+            blob.size = size;
+            totalBytes_ += size;
+        }
+        it = entries_.emplace(url, ImageCacheEntry{}).first;
+    }
+    auto& entry        = it->second;
+    entry.url          = url;
+    entry.hash         = hash;
+    entry.size         = size;
+    entry.expires      = expires;
+    entry.lastUsed     = now;
+    entry.etag         = headers.etag;
+    entry.lastModified = headers.lastModified;
+    dirty_             = true;
+
+    // Si libera un po' più del necessario, per non ripetere la pulizia a ogni immagine
+    const uint64_t maxBytes = static_cast<uint64_t>(MAX_SIZE_MB) * 1024 * 1024;
+    if (totalBytes_ > maxBytes) trim(maxBytes / 10 * 9);
+}
+
+void ImageCache::refresh(const std::string& url, const ImageCacheHeaders& headers) {
+    const int64_t now     = nowSeconds();
+    const int64_t expires = expiresAt(headers.cacheControl, now);
+    if (expires < 0) {
+        remove(url);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it == entries_.end()) return;
+        it->second.expires = expires;
+        // Un 304 può omettere i validatori: restano quelli di prima
+        if (!headers.etag.empty()) it->second.etag = headers.etag;
+        if (!headers.lastModified.empty()) it->second.lastModified = headers.lastModified;
+        dirty_ = true;
+    }
+    saveIndex(false);
+}
+
+void ImageCache::remove(const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(url);
+    if (it != entries_.end()) erase(it);
+}
+
+void ImageCache::setMaxSize(size_t megabytes) {
+    MAX_SIZE_MB = megabytes;
+    auto* cache = get();
+    {
+        std::lock_guard<std::mutex> lock(cache->mutex_);
+        cache->trim(static_cast<uint64_t>(megabytes) * 1024 * 1024);
+    }
+    cache->saveIndex(true);
+}
+
+void ImageCache::erase(std::unordered_map<std::string, ImageCacheEntry>::iterator it) {
+    auto blob = blobs_.find(it->second.hash);
+    if (blob != blobs_.end() && --blob->second.refs == 0) {
+        totalBytes_ -= blob->second.size;
+        std::error_code ec;
+        std::filesystem::remove(blobPath(blob->first), ec);
+        blobs_.erase(blob);
+    }
+    entries_.erase(it);
+    dirty_ = true;
+}
+
+void ImageCache::trim(uint64_t maxBytes) {
+    if (totalBytes_ <= maxBytes) return;
+    std::vector<std::unordered_map<std::string, ImageCacheEntry>::iterator> order;
+    order.reserve(entries_.size());
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) order.push_back(it);
+    std::sort(order.begin(), order.end(),
+              [](const auto& a, const auto& b) { return a->second.lastUsed < b->second.lastUsed; });
+
+    size_t removed = 0;
+    for (auto it : order) {
+        if (totalBytes_ <= maxBytes) break;
+        erase(it);
+        ++removed;
+    }
+    brls::Logger::debug("ImageCache: Evicted {} images, {} KB left", removed, totalBytes_ / 1024);
+}
+
+void ImageCache::saveIndex(bool force) {
+    // Bloccato per tutto il salvataggio: un indice più vecchio non può sovrascriverne uno più recente
+    std::lock_guard<std::mutex> saveLock(saveMutex_);
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int64_t now = nowSeconds();
+        if (!dirty_ || (!force && now - lastSave_ < INDEX_SAVE_INTERVAL)) return;
+        json j = json::array();
+        for (const auto& pair : entries_) j.push_back(pair.second);
+        text      = j.dump();
+        dirty_    = false;
+        lastSave_ = now;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    const std::filesystem::path tempFile = indexFile_.string() + ".tmp";
+    {
+        std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+        out << text;
+        if (!out) {
+            brls::Logger::error("ImageCache: Failed to write the index");
+            out.close();
+            std::remove(tempFile.string().c_str());
+            return;
+        }
+    }
+    std::filesystem::rename(tempFile, indexFile_, ec);
+    if (ec) {
+        brls::Logger::error("ImageCache: Failed to replace the index: {}", ec.message());
+        std::remove(tempFile.string().c_str());
+    }
+}
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <utility>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <borealis/core/touch/tap_gesture.hpp>
 #include <borealis/views/dialog.hpp>
 #include <borealis/core/thread.hpp>
@@ -13,6 +16,10 @@
 #include "utils/image_helper.hpp"
 #include "utils/activity_helper.hpp"
 #include "view/custom_button.hpp"
+#include "utils/text_helper.hpp"
+#include "tsvitch/util/channel_diff.hpp"
+#include "tsvitch/util/channel_view.hpp"
+#include "tsvitch/util/channel_search.hpp"
 
 #include "core/HistoryManager.hpp"
 #include "core/FavoriteManager.hpp"
@@ -25,6 +32,38 @@
 
 using namespace brls::literals;
 
+// Oltre questa quota di canali cambiati conviene ricostruire tutto invece di applicare le differenze
+static constexpr size_t DELTA_MAX_RATIO = 4;
+
+// Risultati della ricerca mostrati subito; gli altri arrivano al frame successivo
+static constexpr size_t SEARCH_FIRST_BATCH = 60;
+
+// Risultati della ricerca con l'indice, i più rilevanti
+static constexpr size_t SEARCH_MAX_RESULTS = 2000;
+
+// Cache completa con l'indice dei gruppi e gli ordinamenti salvati, costruito sul thread in background che la legge
+static tsvitch::ChannelGroups loadGroupedCache() {
+    auto* cache = ChannelManager::get();
+    auto store  = std::make_shared<const tsvitch::ChannelStore>(cache->loadIfValid());
+    return tsvitch::ChannelGroups(store, cache->loadOrders(*store), HistoryManager::get()->watchCounts());
+}
+
+// Ordinamento dei canali scelto nelle impostazioni
+static tsvitch::ChannelOrder configuredChannelOrder() {
+    int value = ProgramConfig::instance().getIntOption(SettingItem::CHANNEL_ORDER);
+    if (value < 0 || value >= (int)tsvitch::CHANNEL_ORDER_COUNT) value = 0;
+    return static_cast<tsvitch::ChannelOrder>(value);
+}
+
+// Data di comparsa dei canali nuovi negli ordinamenti
+static uint32_t nowSeconds() {
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Rientro di ogni livello delle cartelle dei gruppi
+static constexpr float GROUP_INDENT = 20;
+
 class DynamicGroupChannels : public RecyclingGridItem {
 public:
     explicit DynamicGroupChannels(const std::string& xml) {
@@ -36,11 +75,14 @@ public:
 
     void setTitle(const std::string& title) { this->labelTitle->setText(title); }
 
+    void setDepth(size_t depth) { this->labelTitle->setMarginLeft(GROUP_INDENT * depth); }
+
     void setSelected(bool selected) { this->labelTitle->setTextColor(selected ? selectedColor : fontColor); }
 
     void prepareForReuse() override {
         this->labelTitle->setText("");
         this->labelTitle->setTextColor(fontColor);
+        this->labelTitle->setMarginLeft(0);
     }
 
     void cacheForReuse() override {}
@@ -55,70 +97,85 @@ private:
     NVGcolor fontColor{};
 };
 
+// Lista dei gruppi come albero di cartelle: le righe sono solo quelle delle cartelle aperte
 class DataSourceUpList : public RecyclingGridDataSource {
 public:
-    using OnGroupSelected = std::function<void(const std::string&)>;
-    explicit DataSourceUpList(std::vector<std::string> result, OnGroupSelected cb = nullptr)
-        : list(std::move(result)), onGroupSelected(cb) {}
+    // Indice del gruppo scelto nei titoli
+    using OnGroupSelected = std::function<void(size_t)>;
+    explicit DataSourceUpList(std::shared_ptr<const tsvitch::GroupTree> tree, OnGroupSelected cb = nullptr)
+        : rows(std::move(tree)), onGroupSelected(cb) {}
 
     RecyclingGridItem* cellForRow(RecyclingGrid* recycler, size_t index) override {
         DynamicGroupChannels* item = (DynamicGroupChannels*)recycler->dequeueReusableCell("Cell");
-        item->setTitle(this->list[index]);
-        item->setSelected(index == selectedIndex);  // Imposta sempre la selezione!
+        const uint32_t id          = rows.node(index);
+        const auto& node           = rows.tree().node(id);
+        if (node.folder())
+            item->setTitle(fmt::format("{} {} ({})", rows.expanded(id) ? "-" : "+", node.label, node.groupCount));
+        else
+            item->setTitle(node.label);
+        item->setDepth(node.depth);
+        item->setSelected(id == selectedNode);  // Imposta sempre la selezione!
         return item;
     }
 
-    size_t getItemCount() override { return list.size(); }
-
-    void setSelectedIndex(RecyclingGrid* recycler, size_t index) {
-        brls::Logger::debug("setSelectedIndex: {}", index);
-        if (index >= list.size()) return;
-        selectedIndex = index;
-        auto* item    = dynamic_cast<DynamicGroupChannels*>(recycler->getGridItemByIndex(index));
-        if (!item) return;
-        item->setSelected(true);
-
-        // Salva l'indice selezionato
-        ProgramConfig::instance().setSettingItem(SettingItem::GROUP_SELECTED_INDEX, static_cast<int>(index));
-
-        if (onGroupSelected) onGroupSelected(list[index]);
+    size_t getItemCount() override { return rows.size(); }
+
+    // Seleziona il gruppo aprendo le cartelle che lo contengono; riga del gruppo, o getItemCount() se non esiste
+    size_t selectGroup(RecyclingGrid* recycler, size_t group) {
+        brls::Logger::debug("selectGroup: {}", group);
+        const size_t count = rows.size();
+        const size_t row   = rows.reveal(static_cast<uint32_t>(group));
+        if (row >= rows.size()) return row;
+        // Righe nuove: le celle già create non corrispondono più
+        if (rows.size() != count) {
+            recycler->setDefaultCellFocus(row);
+            recycler->reloadData();
+        }
+        this->select(recycler, group);
+        return row;
     }
 
     void onItemSelected(RecyclingGrid* recycler, size_t index) override {
         brls::Logger::debug("onItemSelected: {}", index);
-        std::vector<RecyclingGridItem*>& items = recycler->getGridItems();
-        for (auto& i : items) {
-            auto* cell = dynamic_cast<DynamicGroupChannels*>(i);
-            if (cell) cell->setSelected(false);
+        if (index >= rows.size()) return;
+        const auto& node = rows.tree().node(rows.node(index));
+        if (!node.folder()) {
+            this->select(recycler, node.group);
+            return;
         }
 
-        selectedIndex = index;
-
-        auto* item = dynamic_cast<DynamicGroupChannels*>(recycler->getGridItemByIndex(index));
-        if (!item) return;
-        item->setSelected(true);
+        // Le celle vengono ricreate: non durante la gestione del tocco su una di esse
+        rows.toggle(index);
+        brls::sync([recycler, source = this, index]() {
+            if (recycler->getDataSource() != source) return;
+            recycler->setDefaultCellFocus(index);
+            recycler->reloadData();
+            brls::Application::giveFocus(recycler);
+        });
+    }
 
-        // Salva l'indice selezionato
-        ProgramConfig::instance().setSettingItem(SettingItem::GROUP_SELECTED_INDEX, static_cast<int>(index));
+    void setPersistSelection(bool value) { persistSelection = value; }
 
-        if (onGroupSelected) onGroupSelected(list[index]);
-    }
+    void clearData() override { rows = tsvitch::GroupTreeRows(); }
 
-    void appendData(const std::vector<std::string>& data) {
-        this->list.insert(this->list.end(), data.begin(), data.end());
-    }
+private:
+    void select(RecyclingGrid* recycler, size_t group) {
+        selectedNode = rows.tree().nodeOf(static_cast<uint32_t>(group));
+        for (auto* i : recycler->getGridItems()) {
+            auto* cell = dynamic_cast<DynamicGroupChannels*>(i);
+            if (cell && cell->getIndex() < rows.size()) cell->setSelected(rows.node(cell->getIndex()) == selectedNode);
+        }
 
-    void clearData() override { this->list.clear(); }
+        // Salva l'indice selezionato
+        if (persistSelection)
+            ProgramConfig::instance().setSettingItem(SettingItem::GROUP_SELECTED_INDEX, static_cast<int>(group));
 
-    const std::string& getGroupNameByIndex(size_t index) const {
-        static std::string empty;
-        if (index < list.size()) return list[index];
-        return empty;
+        if (onGroupSelected) onGroupSelected(group);
     }
 
-private:
-    std::vector<std::string> list;
-    size_t selectedIndex = -1;
+    tsvitch::GroupTreeRows rows;
+    uint32_t selectedNode = tsvitch::GroupTree::NONE;
+    bool persistSelection = true;
     OnGroupSelected onGroupSelected;
 };
 
@@ -185,32 +242,30 @@ protected:
     NVGcolor fontColor     = brls::Application::getTheme().getColor("brls/text");
 };
 
+// Vista su uno store condiviso: il LiveM3u8 viene ricostruito solo per le celle visibili
 class DataSourceLiveVideoList : public RecyclingGridDataSource {
 public:
-    explicit DataSourceLiveVideoList(const tsvitch::LiveM3u8ListResult& result) : videoList(result) {}
+    explicit DataSourceLiveVideoList(tsvitch::ChannelView channels) : channels(std::move(channels)) {}
     RecyclingGridItem* cellForRow(RecyclingGrid* recycler, size_t index) override {
-        tsvitch::LiveM3u8& r = this->videoList[index];
-        // brls::Logger::info("cellForRow: {} [{}]", r.title, index);
         RecyclingGridItemLiveVideoCard* item = (RecyclingGridItemLiveVideoCard*)recycler->dequeueReusableCell("Cell");
-        item->setChannel(r);
+        item->setChannel(channels.at(index));
         return item;
     }
 
-    size_t getItemCount() override { return videoList.size(); }
+    size_t getItemCount() override { return channels.size(); }
 
     void onItemSelected(RecyclingGrid* recycler, size_t index) override {
-        HistoryManager::get()->add(videoList[index]);
-        Intent::openLive(videoList, index, [recycler]() { recycler->reloadData(); });
+        HistoryManager::get()->add(channels.at(index));
+        Intent::openLive(channels, index, [recycler]() { recycler->reloadData(); });
     }
 
-    void appendData(const tsvitch::LiveM3u8ListResult& data) {
-        this->videoList.insert(this->videoList.end(), data.begin(), data.end());
-    }
+    void clearData() override { this->channels = {}; }
 
-    void clearData() override { this->videoList.clear(); }
+    /// Sostituisce i canali senza ricreare la griglia (seguito da notifyDataChanged)
+    void setChannels(tsvitch::ChannelView channels) { this->channels = std::move(channels); }
 
 private:
-    tsvitch::LiveM3u8ListResult videoList;
+    tsvitch::ChannelView channels;
 };
 
 HomeLive::HomeLive() {
@@ -235,48 +290,27 @@ HomeLive::HomeLive() {
 
     // Sottoscrivi all'evento di cambio M3U8
     OnM3U8UrlChanged.subscribe([this]() {
-        brls::Logger::debug("OnM3U8UrlChanged: showing skeleton and requesting channel list");
-        // Mostra lo skeleton per indicare che stiamo caricando
-        brls::Threading::sync([this]() {
-            recyclingGrid->showSkeleton();
-            upRecyclingGrid->setVisibility(brls::Visibility::GONE);
-        });
-        
-        ChannelManager::get()->remove();
-        this->requestLiveList();
-        //reset index group
-        this->selectGroupIndex(0);
+        brls::Logger::debug("OnM3U8UrlChanged: switching channel source");
+        this->switchSource();
     });
 
     // Sottoscrivi all'evento di cambio modalità IPTV
     OnIPTVModeChanged.subscribe([this]() {
-        brls::Logger::debug("OnIPTVModeChanged: showing skeleton and requesting channel list");
-        // Mostra lo skeleton per indicare che stiamo caricando
-        brls::Threading::sync([this]() {
-            recyclingGrid->showSkeleton();
-            upRecyclingGrid->setVisibility(brls::Visibility::GONE);
-        });
-        
-        ChannelManager::get()->remove();
-        this->requestLiveList();
-        //reset index group
-        this->selectGroupIndex(0);
+        brls::Logger::debug("OnIPTVModeChanged: switching channel source");
+        this->switchSource();
     });
 
     // Sottoscrivi all'evento di cambio Xtream
     OnXtreamChanged.subscribe([this](const XtreamData& xtreamData) {
-        brls::Logger::debug("OnXtreamChanged: url={}, username={}, showing skeleton and requesting channel list", 
+        brls::Logger::debug("OnXtreamChanged: url={}, username={}, switching channel source", 
                            xtreamData.url, xtreamData.username);
-        // Mostra lo skeleton per indicare che stiamo caricando
-        brls::Threading::sync([this]() {
-            recyclingGrid->showSkeleton();
-            upRecyclingGrid->setVisibility(brls::Visibility::GONE);
-        });
-        
-        ChannelManager::get()->remove();
-        this->requestLiveList();
-        //reset index group
-        this->selectGroupIndex(0);
+        this->switchSource();
+    });
+
+    this->channelOrder = configuredChannelOrder();
+    OnChannelOrderChanged.subscribe([this]() {
+        this->channelOrder = configuredChannelOrder();
+        this->applyChannelOrder();
     });
     
     // Mostra sempre lo skeleton all'inizio per UI non-bloccante
@@ -302,9 +336,10 @@ HomeLive::HomeLive() {
                 return;
             }
             
-            auto cachedChannels = ChannelManager::get()->loadIfValid(); 
+            auto cachedChannels = this->loadCachedChannels(validityFlag);
+            bool needsRefresh   = !cachedChannels.empty() && ChannelManager::get()->needsRevalidation();
             
-            brls::sync([this, cachedChannels, validityFlag]() {
+            brls::sync([this, cachedChannels = std::move(cachedChannels), needsRefresh, validityFlag]() mutable {
                 // Controlla di nuovo la validità prima di aggiornare l'UI
                 if (!validityFlag || !validityFlag->load()) {
                     brls::Logger::debug("HomeLive: Xtream sync task canceled - app exiting");
@@ -312,8 +347,13 @@ HomeLive::HomeLive() {
                 }
                 
                 if (!cachedChannels.empty()) {
-                    brls::Logger::info("HomeLive: Using valid Xtream cache with {} channels", cachedChannels.size());
-                    this->onLiveList(cachedChannels, false);
+                    brls::Logger::info("HomeLive: Using valid Xtream cache with {} channels", cachedChannels.channelCount());
+                    this->onLiveList(std::move(cachedChannels), false);
+                    // Cache vecchia: resta visibile, la lista nuova arriva come differenze
+                    if (needsRefresh) {
+                        brls::Logger::info("HomeLive: Xtream cache is stale, revalidating in background");
+                        this->requestLiveList();
+                    }
                 } else {
                     brls::Logger::info("HomeLive: Xtream cache invalid/empty, requesting fresh data");
                     this->requestLiveList();
@@ -335,10 +375,11 @@ HomeLive::HomeLive() {
             brls::Logger::debug("HomeLive: Starting smart cache check in background thread");
             
             // Cache più lunga per M3U8 (1 mese) perché cambia meno frequentemente
-            auto cachedChannels = ChannelManager::get()->loadIfValid();
-            brls::Logger::info("HomeLive: Smart cache check completed, found {} channels", cachedChannels.size());
+            auto cachedChannels = this->loadCachedChannels(validityFlag);
+            bool needsRefresh   = !cachedChannels.empty() && ChannelManager::get()->needsRevalidation();
+            brls::Logger::info("HomeLive: Smart cache check completed, found {} channels", cachedChannels.channelCount());
             
-            brls::sync([this, cachedChannels, validityFlag]() {
+            brls::sync([this, cachedChannels = std::move(cachedChannels), needsRefresh, validityFlag]() mutable {
                 // Controlla di nuovo la validità prima di aggiornare l'UI
                 if (!validityFlag || !validityFlag->load()) {
                     brls::Logger::debug("HomeLive: M3U8 sync task canceled - app exiting");
@@ -346,8 +387,13 @@ HomeLive::HomeLive() {
                 }
                 
                 if (!cachedChannels.empty()) {
-                    brls::Logger::info("HomeLive constructor: Using valid M3U8 cache ({} channels found)", cachedChannels.size());
-                    this->onLiveList(cachedChannels, false);
+                    brls::Logger::info("HomeLive constructor: Using valid M3U8 cache ({} channels found)", cachedChannels.channelCount());
+                    this->onLiveList(std::move(cachedChannels), false);
+                    // Cache vecchia: resta visibile, la lista nuova arriva come differenze
+                    if (needsRefresh) {
+                        brls::Logger::info("HomeLive constructor: M3U8 cache is stale, revalidating in background");
+                        this->requestLiveList();
+                    }
                 } else {
                     brls::Logger::info("HomeLive constructor: M3U8 cache is invalid or empty, requesting fresh channels");
                     this->requestLiveList();
@@ -358,21 +404,247 @@ HomeLive::HomeLive() {
     }
 }
 
+void HomeLive::switchSource() {
+    // La lista mostrata è di un'altra sorgente: non va confrontata con quella nuova
+    brls::Threading::sync([this]() {
+        recyclingGrid->showSkeleton();
+        upRecyclingGrid->setVisibility(brls::Visibility::GONE);
+        this->channelsList   = std::make_shared<const tsvitch::ChannelStore>();
+        this->channelGroups  = {};
+        this->groupTitles.clear();
+        this->groupTree.reset();
+        this->showingPreview = false;
+        this->showingPartial = false;
+        this->searchIndex.reset();
+        ++listGeneration;
+    });
+    //reset index group
+    ProgramConfig::instance().setSettingItem(SettingItem::GROUP_SELECTED_INDEX, 0);
+
+    // Sorgente già usata: la sua cache compare subito e viene riconvalidata se vecchia
+    brls::Threading::async([this, validityFlag = this->validityFlag] {
+        if (!validityFlag || !validityFlag->load()) return;
+
+        auto cachedChannels = loadGroupedCache();
+        bool needsRefresh   = !cachedChannels.empty() && ChannelManager::get()->needsRevalidation();
+
+        brls::sync([this, cachedChannels = std::move(cachedChannels), needsRefresh, validityFlag]() mutable {
+            if (!validityFlag || !validityFlag->load()) return;
+
+            if (!cachedChannels.empty()) {
+                brls::Logger::info("HomeLive: Using cached channels of the new source ({} channels)", cachedChannels.channelCount());
+                this->onLiveList(std::move(cachedChannels), false);
+                if (needsRefresh) this->requestLiveList();
+            } else {
+                this->requestLiveList();
+            }
+        });
+    });
+}
+
+tsvitch::ChannelGroups HomeLive::loadCachedChannels(const std::shared_ptr<std::atomic<bool>>& validityFlag) {
+    // Prima la directory dei gruppi e i canali del gruppo selezionato l'ultima volta:
+    // lista dei gruppi e griglia compaiono senza aspettare la lettura di tutta la cache
+    auto directory = ChannelManager::get()->loadGroupIndexIfValid();
+    if (!directory.empty()) {
+        std::map<std::string, std::vector<ChannelManager::CachedGroup>> byTitle;
+        for (auto& group : directory) byTitle[tsvitch::ChannelGroups::displayName(group.name)].push_back(std::move(group));
+
+        std::vector<std::string> titles;
+        titles.reserve(byTitle.size());
+        for (const auto& pair : byTitle) titles.push_back(pair.first);
+        int lastIndex = ProgramConfig::instance().getSettingItem(SettingItem::GROUP_SELECTED_INDEX, 0);
+        if (lastIndex < 0 || lastIndex >= (int)titles.size()) lastIndex = 0;
+
+        tsvitch::ChannelGroups channels(
+            std::make_shared<const tsvitch::ChannelStore>(ChannelManager::get()->loadGroups(byTitle[titles[lastIndex]])));
+        if (!channels.empty()) {
+            auto tree = std::make_shared<const tsvitch::GroupTree>(titles);
+            brls::sync([this, validityFlag, channels = std::move(channels), titles = std::move(titles),
+                        tree = std::move(tree), lastIndex]() mutable {
+                if (!validityFlag || !validityFlag->load()) return;
+                this->showCachedGroup(std::move(channels), std::move(titles), std::move(tree),
+                                      static_cast<size_t>(lastIndex));
+            });
+        }
+    }
+    // Il resto della lista, in background mentre il gruppo è già visibile
+    return loadGroupedCache();
+}
+
+void HomeLive::showCachedGroup(tsvitch::ChannelGroups channels, std::vector<std::string> titles,
+                               std::shared_ptr<const tsvitch::GroupTree> tree, size_t selectedIndex) {
+    // La lista completa è già arrivata
+    if (!this->channelsList->empty()) return;
+    brls::Logger::info("HomeLive: Showing group '{}' ({} channels) before the full cache", titles[selectedIndex],
+                       channels.channelCount());
+
+    this->channelsList   = channels.store();
+    this->channelGroups  = std::move(channels);
+    this->showingPartial = true;
+    this->partialGroup   = titles[selectedIndex];
+    ++listGeneration;
+
+    // I gruppi sono già quelli definitivi: la selezione può essere salvata
+    this->groupTitles = std::move(titles);
+    this->groupTree   = std::move(tree);
+    this->showGroup(this->partialGroup);
+    this->showGroupList(selectedIndex, true);
+}
+
 void HomeLive::onError(const std::string& error) {
     brls::Logger::error("Fragment HomeLive: onError: {}", error);
     brls::sync([this, error]() {
+        // Riconvalida in background fallita: si continua a mostrare la cache
+        if (!this->channelsList->empty() && !this->showingPreview) {
+            brls::Logger::warning("Fragment HomeLive: keeping {} cached channels", this->channelsList->size());
+            return;
+        }
         this->recyclingGrid->setError(error);
         this->upRecyclingGrid->setVisibility(brls::Visibility::GONE);
+
+        //dialog to show error
+        auto dialog = new brls::Dialog("hints/network_error"_i18n);
+        dialog->addButton("hints/back"_i18n, []() {});
+        dialog->open();
     });
+}
+
+void HomeLive::onLiveList(tsvitch::ChannelGroups result, bool firstLoad) {
+    brls::Logger::info("Fragment HomeLive: onLiveList - received {} channels in {} groups ({} KB)", result.channelCount(),
+                       result.size(), result.empty() ? 0 : result.store()->memoryUsage() / 1024);
+    // Aggiornamento di una lista completa già mostrata: si applicano solo le differenze
+    if (firstLoad && !this->channelsList->empty() && !this->showingPreview && !this->showingPartial && !result.empty()) {
+        this->applyLiveListDelta(std::move(result));
+        return;
+    }
+    this->showLiveList(std::move(result), firstLoad, false);
+}
+
+void HomeLive::applyLiveListDelta(tsvitch::ChannelGroups result) {
+    auto isValidFlag = validityFlag;
+    uint64_t generation = listGeneration;
+    // Cache della sorgente di questa lista, anche se nel frattempo cambia quella configurata
+    auto* cache = ChannelManager::get();
+
+    // Diff e journal su disco in background: sul main
+    // thread restano solo gli scambi dei contenitori e l'aggiornamento della griglia
+    brls::Threading::async([this, isValidFlag, generation, cache, base = this->channelsList, result = std::move(result),
+                            oldTitles = this->groupTitles, previousOrders = this->channelGroups.orders()]() mutable {
+        if (!isValidFlag->load() || generation != listGeneration) return;
+
+        auto diff_start = std::chrono::high_resolution_clock::now();
+        auto diff       = tsvitch::ChannelDiff::compute(*base, *result.store());
+        auto diff_end   = std::chrono::high_resolution_clock::now();
+        brls::Logger::info("HomeLive: Channel diff in {}ms - added: {}, changed: {}, removed: {}, touched groups: {}",
+                           std::chrono::duration_cast<std::chrono::milliseconds>(diff_end - diff_start).count(),
+                           diff.added.size(), diff.changed.size(), diff.removed.size(), diff.touchedGroups.size());
+
+        // Ordinamenti della lista nuova: i canali già presenti conservano la data in cui sono
+        // comparsi. Con la stessa lista restano quelli di prima
+        auto store  = result.store();
+        auto orders = previousOrders;
+        if (!orders || !orders->matches(*store)) {
+            orders = std::make_shared<const tsvitch::ChannelOrders>(
+                tsvitch::ChannelOrders::compute(*store, nowSeconds(), previousOrders.get(), &diff));
+            cache->saveOrders(*orders);
+        }
+        result = tsvitch::ChannelGroups(store, orders, HistoryManager::get()->watchCounts());
+
+        auto rebuild = [&]() {
+            brls::sync([this, isValidFlag, generation, result = std::move(result)]() mutable {
+                if (!isValidFlag->load() || generation != listGeneration) return;
+                this->showLiveList(std::move(result), true, false);
+            });
+        };
+
+        if (diff.size() > result.channelCount() / DELTA_MAX_RATIO) {
+            brls::Logger::info("HomeLive: Too many changes, rebuilding the channel list");
+            rebuild();
+            return;
+        }
+
+        // L'indice dei gruppi arriva già costruito con la lista nuova
+        auto newTitles = result.titles();
+        auto newTree   = result.groupTree();
+
+        // Con un solo gruppo la lista dei gruppi è nascosta e la griglia va impostata diversamente
+        if ((newTitles.size() <= 1) != (oldTitles.size() <= 1)) {
+            rebuild();
+            return;
+        }
+
+        std::unordered_set<std::string> touched;
+        for (const auto& group : diff.touchedGroups) touched.insert(tsvitch::ChannelGroups::displayName(group));
+
+        cache->saveDeltaWithTimestamp(*result.store(), diff);
+
+        brls::sync([this, isValidFlag, generation, groups = std::move(result), newTitles = std::move(newTitles),
+                    newTree = std::move(newTree), touched = std::move(touched)]() mutable {
+            if (!isValidFlag->load() || generation != listGeneration) return;
+
+            this->channelsList  = groups.store();
+            this->channelGroups = std::move(groups);
+            ++listGeneration;
+            this->buildSearchIndex();
+
+            // Con un solo gruppo la griglia mostra sempre quello
+            std::string selectedGroup;
+            if (this->groupTitles.size() == 1)
+                selectedGroup = this->groupTitles.front();
+            else if (this->selectedGroupIndex >= 0 && this->selectedGroupIndex < (int)this->groupTitles.size())
+                selectedGroup = this->groupTitles[this->selectedGroupIndex];
+
+            if (newTitles != this->groupTitles) {
+                auto it = std::find(newTitles.begin(), newTitles.end(), selectedGroup);
+                size_t index = it != newTitles.end() ? static_cast<size_t>(it - newTitles.begin()) : 0;
+                this->groupTitles = std::move(newTitles);
+                this->groupTree   = std::move(newTree);
+                this->showGroupList(index, true);
+            } else if (touched.count(selectedGroup) && !isSearchActive) {
+                // Solo il gruppo visibile va ridisegnato: la griglia degli altri conserva la lista precedente, identica
+                this->showGroup(selectedGroup);
+            }
+        });
+    });
+}
+
+void HomeLive::onLiveListPreview(tsvitch::ChannelGroups result) {
+    // L'anteprima serve solo quando non c'è ancora nulla da mostrare (nessuna cache)
+    if (!this->channelsList->empty()) return;
+    brls::Logger::info("Fragment HomeLive: onLiveListPreview - showing first {} channels", result.channelCount());
+    this->showLiveList(std::move(result), false, true);
+}
+
+void HomeLive::onLiveListNotModified() {
+    // Lista completa già in memoria: è ancora quella della sorgente
+    if (!this->channelsList->empty() && !this->showingPreview && !this->showingPartial) {
+        brls::Logger::info("Fragment HomeLive: onLiveListNotModified - keeping {} channels", this->channelsList->size());
+        return;
+    }
+
+    brls::Threading::async([this, validityFlag = this->validityFlag] {
+        if (!validityFlag || !validityFlag->load()) return;
+
+        auto cachedChannels = loadGroupedCache();
+
+        brls::sync([this, cachedChannels = std::move(cachedChannels), validityFlag]() mutable {
+            if (!validityFlag || !validityFlag->load()) return;
 
-    //dialog to show error
-    auto dialog = new brls::Dialog("hints/network_error"_i18n);
-    dialog->addButton("hints/back"_i18n, []() {});
-    dialog->open();
+            if (!cachedChannels.empty()) {
+                brls::Logger::info("Fragment HomeLive: onLiveListNotModified - using cache ({} channels)", cachedChannels.channelCount());
+                this->onLiveList(std::move(cachedChannels), false);
+            } else {
+                // Cache illeggibile: i validatori non valgono più, scarica tutto
+                brls::Logger::warning("Fragment HomeLive: onLiveListNotModified - cache unreadable, requesting full list");
+                ChannelManager::get()->remove();
+                this->requestLiveList();
+            }
+        });
+    });
 }
 
-void HomeLive::onLiveList(tsvitch::LiveM3u8ListResult result, bool firstLoad) {
-    brls::Logger::info("Fragment HomeLive: onLiveList - received {} channels", result.size());
+void HomeLive::showLiveList(tsvitch::ChannelGroups result, bool firstLoad, bool preview) {
     if (result.empty()) {
         recyclingGrid->setEmpty();
         upRecyclingGrid->setVisibility(brls::Visibility::GONE);
@@ -406,150 +678,60 @@ void HomeLive::onLiveList(tsvitch::LiveM3u8ListResult result, bool firstLoad) {
         return true;
     });
 
-    // Salva channelsList SUBITO per accesso thread-safe
-    this->channelsList = std::move(result); // Move invece di copy!
+    // Lista e indice dei gruppi arrivano pronti dal thread in background: qui si scambiano solo i puntatori
+    this->channelsList   = result.store();
+    this->channelGroups  = std::move(result);
+    this->showingPreview = preview;
+    const bool wasPartial = this->showingPartial;
+    this->showingPartial  = false;
+    ++listGeneration;
+    // Un'anteprima verrà sostituita a breve: la ricerca usa la scansione completa
+    if (!preview) this->buildSearchIndex();
+    // Lista scaricata senza una precedente da cui ereditare gli ordinamenti
+    if (!preview && !this->channelGroups.orders()) this->buildChannelOrders();
     
-    // Fai il grouping e UI update SUL MAIN THREAD per evitare il delay di 36s del brls::sync()
-    // Meglio bloccare 600ms che aspettare 36 secondi!
     auto isValidFlag = validityFlag;
-    brls::sync([this, isValidFlag, firstLoad]() {
+    brls::sync([this, isValidFlag, firstLoad, preview, wasPartial]() {
         if (!isValidFlag->load()) return;
-        
-        auto grouping_start = std::chrono::high_resolution_clock::now();
-        
-        // Raggruppa i canali per groupTitle - unica passata
-        std::unordered_map<std::string, std::vector<size_t>> groupIndices;
-        groupIndices.reserve(100);
-        
-        for (size_t i = 0; i < this->channelsList.size(); ++i) {
-            std::string groupTitle = this->channelsList[i].groupTitle;
-            // Assegna un nome di default ai canali senza gruppo
-            if (groupTitle.empty()) {
-                groupTitle = "Uncategorized";
-            }
-            groupIndices[groupTitle].push_back(i);
-        }
-        
-        std::vector<std::string> groupTitles;
-        groupTitles.reserve(groupIndices.size());
-        for (const auto& pair : groupIndices) {
-            groupTitles.push_back(pair.first);
-        }
-        
-        // Ordina alfabeticamente
-        std::sort(groupTitles.begin(), groupTitles.end());
-        
-        auto grouping_end = std::chrono::high_resolution_clock::now();
-        auto grouping_duration = std::chrono::duration_cast<std::chrono::milliseconds>(grouping_end - grouping_start);
-        brls::Logger::info("HomeLive: Grouping completed in {}ms - Found {} groups", grouping_duration.count(), groupTitles.size());
-        
-        // Leggi lastIndex dal config
-        int lastIndex = ProgramConfig::instance().getSettingItem(SettingItem::GROUP_SELECTED_INDEX, 0);
-        if (lastIndex >= (int)groupTitles.size()) lastIndex = 0;
-        std::string selectedGroup = groupTitles.empty() ? "" : groupTitles[lastIndex];
-        
-        // Prepara il gruppo selezionato
-        tsvitch::LiveM3u8ListResult filtered;
-        if (!selectedGroup.empty() && groupIndices.count(selectedGroup)) {
-            const auto& indices = groupIndices[selectedGroup];
-            filtered.reserve(indices.size());
-            for (size_t idx : indices) {
-                filtered.push_back(this->channelsList[idx]);
-            }
-        }
-        
-        brls::Logger::info("HomeLive: Selected group '{}' with {} channels", selectedGroup, filtered.size());
-        
-        // Cache il gruppo selezionato
-        {
-            std::lock_guard<std::mutex> lock(groupCacheMutex);
-            groupCache.clear();
-            groupCache[selectedGroup] = filtered;
-        }
-        
-        // Imposta il DataSource principale (già sul main thread, no brls::sync necessario)
-        brls::Logger::info("HomeLive: Setting DataSource with {} filtered channels", filtered.size());
-        if (filtered.empty())
-            recyclingGrid->setEmpty();
-        else
-            recyclingGrid->setDataSource(new DataSourceLiveVideoList(std::move(filtered)));
-        
-        // Setup UI gruppi
-        if (groupTitles.size() > 1) {
-            upRecyclingGrid->setVisibility(brls::Visibility::VISIBLE);
-            auto* upList = new DataSourceUpList(groupTitles, [this](const std::string& group) {
-                tsvitch::LiveM3u8ListResult filtered;
-                {
-                    std::lock_guard<std::mutex> lock(groupCacheMutex);
-                    if (groupCache.count(group)) {
-                        filtered = groupCache[group];
-                        brls::Logger::debug("HomeLive: Using cached group '{}' with {} channels", group, filtered.size());
-                    } else {
-                        brls::Logger::warning("HomeLive: Cache miss for group '{}', filtering on-demand", group);
-                        for (const auto& item : this->channelsList) {
-                            if (item.groupTitle == group) filtered.push_back(item);
-                        }
-                        groupCache[group] = filtered;
-                    }
-                }
-                if (filtered.empty())
-                    recyclingGrid->setEmpty();
-                else
-                    recyclingGrid->setDataSource(new DataSourceLiveVideoList(filtered));
-            });
-            upRecyclingGrid->setDataSource(upList);
-            this->selectGroupIndex(static_cast<size_t>(lastIndex));
+
+        std::vector<std::string> groupTitles = this->channelGroups.titles();
+
+        // Stessi gruppi letti dalla directory della cache: la griglia del gruppo già
+        // mostrato ha gli stessi canali, va cambiata solo se nel frattempo se n'è scelto un altro
+        if (wasPartial && groupTitles == this->groupTitles) {
+            // Il gruppo letto prima è nell'ordine della playlist
+            if (this->selectedGroupIndex >= 0 && this->selectedGroupIndex < (int)this->groupTitles.size() &&
+                (this->groupTitles[this->selectedGroupIndex] != this->partialGroup ||
+                 this->channelOrder != tsvitch::ChannelOrder::PLAYLIST) &&
+                !isSearchActive)
+                this->showGroup(this->groupTitles[this->selectedGroupIndex]);
         } else {
-            upRecyclingGrid->setVisibility(brls::Visibility::GONE);
+            // Leggi lastIndex dal config
+            int lastIndex = ProgramConfig::instance().getSettingItem(SettingItem::GROUP_SELECTED_INDEX, 0);
+            if (lastIndex >= (int)groupTitles.size()) lastIndex = 0;
+            std::string selectedGroup = groupTitles.empty() ? "" : groupTitles[lastIndex];
+
+            // Imposta il DataSource principale (già sul main thread, no brls::sync necessario)
+            this->showGroup(selectedGroup);
+
+            // Setup UI gruppi
+            this->groupTitles = std::move(groupTitles);
+            this->groupTree   = this->channelGroups.groupTree();
+            // Con una lista parziale gli indici dei gruppi non sono quelli definitivi
+            this->showGroupList(static_cast<size_t>(lastIndex), !preview);
         }
+        this->partialGroup.clear();
         
-        // Precarica gli altri gruppi in background - IN UN THREAD ASYNC SEPARATO per non bloccare l'UI
-        brls::Threading::async([this, groupTitles = std::move(groupTitles), groupIndices = std::move(groupIndices), 
-                                selectedGroup, isValidFlag]() {
-            if (groupTitles.size() <= 1) return;
-            
-            auto preload_start = std::chrono::high_resolution_clock::now();
-            size_t groupsProcessed = 0;
-            
-            for (const auto& group : groupTitles) {
-                if (!isValidFlag->load()) return;
-                if (group == selectedGroup) continue;
-                
-                tsvitch::LiveM3u8ListResult filteredBg;
-                if (groupIndices.count(group)) {
-                    const auto& indices = groupIndices.at(group);
-                    filteredBg.reserve(indices.size());
-                    
-                    for (size_t idx : indices) {
-                        if (idx < this->channelsList.size()) {
-                            filteredBg.push_back(this->channelsList[idx]);
-                        }
-                    }
-                }
-                
-                {
-                    std::lock_guard<std::mutex> lock(groupCacheMutex);
-                    groupCache[group] = std::move(filteredBg);
-                }
-                
-                groupsProcessed++;
-                if (groupsProcessed % 10 == 0) {
-                    std::this_thread::yield();
-                }
-            }
-            
-            auto preload_end = std::chrono::high_resolution_clock::now();
-            auto preload_duration = std::chrono::duration_cast<std::chrono::milliseconds>(preload_end - preload_start);
-            brls::Logger::info("HomeLive: Background group preloading completed in {}ms ({} groups)", preload_duration.count(), groupsProcessed);
-        });
+        // La lista definitiva arriverà a breve e sostituirà questa
+        if (preview) return;
         
         // Salva in background se firstLoad (non blocca UI)
         if (firstLoad) {
-            brls::Logger::info("HomeLive: First load detected, will save {} channels with timestamp (async)", this->channelsList.size());
-            auto toSave = this->channelsList;
-            brls::Threading::async([data = std::move(toSave)]() {
+            brls::Logger::info("HomeLive: First load detected, will save {} channels with timestamp (async)", this->channelsList->size());
+            // Lo store è immutabile: basta condividerlo, senza copie
+            brls::Threading::async([data = this->channelsList, cache = ChannelManager::get()]() {
                 try {
-                    ChannelManager::get()->saveWithTimestamp(data);
+                    cache->saveWithTimestamp(*data);
                     brls::Logger::info("HomeLive: Async saveWithTimestamp completed successfully");
                 } catch (const std::exception& e) {
                     brls::Logger::error("HomeLive: Exception in async saveWithTimestamp: {}", e.what());
@@ -561,31 +743,110 @@ void HomeLive::onLiveList(tsvitch::LiveM3u8ListResult result, bool firstLoad) {
     });
 }
 
+void HomeLive::buildSearchIndex() {
+    this->searchIndex.reset();
+    auto isValidFlag    = validityFlag;
+    uint64_t generation = listGeneration;
+    brls::Threading::async([this, isValidFlag, generation, store = this->channelsList]() {
+        if (!isValidFlag->load() || generation != listGeneration) return;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        auto index = std::make_shared<const tsvitch::ChannelSearchIndex>(store);
+        brls::Logger::info("HomeLive: Search index for {} channels built in {}ms ({} KB)", store->size(),
+                           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count(),
+                           index->memoryUsage() / 1024);
+
+        brls::sync([this, isValidFlag, generation, index = std::move(index)]() mutable {
+            if (!isValidFlag->load() || generation != listGeneration) return;
+            this->searchIndex = std::move(index);
+        });
+    });
+}
+
+void HomeLive::buildChannelOrders() {
+    auto isValidFlag    = validityFlag;
+    uint64_t generation = listGeneration;
+    brls::Threading::async([this, isValidFlag, generation, store = this->channelsList, cache = ChannelManager::get()]() {
+        if (!isValidFlag->load() || generation != listGeneration) return;
+
+        auto start  = std::chrono::high_resolution_clock::now();
+        auto orders = std::make_shared<const tsvitch::ChannelOrders>(tsvitch::ChannelOrders::compute(*store, nowSeconds()));
+        tsvitch::ChannelGroups groups(store, orders, HistoryManager::get()->watchCounts());
+        brls::Logger::info("HomeLive: Channel orders for {} channels built in {}ms", store->size(),
+                           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count());
+        cache->saveOrders(*orders);
+
+        brls::sync([this, isValidFlag, generation, groups = std::move(groups)]() mutable {
+            if (!isValidFlag->load() || generation != listGeneration) return;
+            // Stessi canali e stessi gruppi: si aggiungono solo le permutazioni
+            this->channelGroups = std::move(groups);
+            if (this->channelOrder != tsvitch::ChannelOrder::PLAYLIST) this->applyChannelOrder();
+        });
+    });
+}
+
+void HomeLive::applyChannelOrder() {
+    // I risultati della ricerca hanno un ordine proprio
+    if (isSearchActive || this->groupTitles.empty()) return;
+    std::string group;
+    if (this->groupTitles.size() == 1)
+        group = this->groupTitles.front();
+    else if (this->selectedGroupIndex >= 0 && this->selectedGroupIndex < (int)this->groupTitles.size())
+        group = this->groupTitles[this->selectedGroupIndex];
+
+    // Stessi canali in un'altra permutazione già pronta: la griglia non viene ricreata
+    auto channels    = this->channelGroups.view(group, this->channelOrder);
+    auto* datasource = dynamic_cast<DataSourceLiveVideoList*>(recyclingGrid->getDataSource());
+    if (!datasource || channels.empty()) return;
+    datasource->setChannels(std::move(channels));
+    recyclingGrid->notifyDataChanged();
+}
+
+void HomeLive::showGroup(const std::string& group) {
+    // Intervallo della permutazione condivisa: nessuna copia degli indici
+    auto channels = this->channelGroups.view(group, this->channelOrder);
+    if (channels.empty()) {
+        // Gruppo non ancora letto dalla cache: arriverà con la lista completa
+        if (this->showingPartial)
+            recyclingGrid->showSkeleton();
+        else
+            recyclingGrid->setEmpty();
+        return;
+    }
+    brls::Logger::debug("HomeLive: Showing group '{}' with {} channels", group, channels.size());
+    recyclingGrid->setDataSource(new DataSourceLiveVideoList(std::move(channels)));
+}
+
+void HomeLive::showGroupList(size_t selectedIndex, bool persistSelection) {
+    if (this->groupTitles.size() <= 1) {
+        upRecyclingGrid->setVisibility(brls::Visibility::GONE);
+        if (this->groupTitles.size() == 1 && !isSearchActive) this->showGroup(this->groupTitles.front());
+        return;
+    }
+
+    auto* upList = new DataSourceUpList(this->groupTree, [this](size_t group) {
+        this->selectedGroupIndex = static_cast<int>(group);
+        this->showGroup(this->groupTitles[group]);
+    });
+    upList->setPersistSelection(persistSelection);
+    upRecyclingGrid->setDataSource(upList);
+
+    // Durante una ricerca la griglia mostra i risultati: il gruppo verrà riselezionato da cancelSearch
+    if (isSearchActive) {
+        this->selectedGroupIndex = static_cast<int>(selectedIndex);
+        return;
+    }
+    upRecyclingGrid->setVisibility(brls::Visibility::VISIBLE);
+    this->selectGroupIndex(selectedIndex);
+}
+
 void HomeLive::selectGroupIndex(size_t index) {
     auto* datasource = dynamic_cast<DataSourceUpList*>(upRecyclingGrid->getDataSource());
     if (!datasource) return;
-    if (index >= datasource->getItemCount()) return;
-    this->selectedGroupIndex = index;
-    datasource->setSelectedIndex(upRecyclingGrid, index);
-    upRecyclingGrid->selectRowAt(index, false);
-
-    std::string selectedGroup = datasource->getGroupNameByIndex(index);
-    tsvitch::LiveM3u8ListResult filtered;
-    {
-        std::lock_guard<std::mutex> lock(groupCacheMutex);
-        if (groupCache.count(selectedGroup)) {
-            filtered = groupCache[selectedGroup];
-        } else {
-            for (const auto& item : this->channelsList) {
-                if (item.groupTitle == selectedGroup) filtered.push_back(item);
-            }
-            groupCache[selectedGroup] = filtered;
-        }
-    }
-    if (filtered.empty())
-        recyclingGrid->setEmpty();
-    else
-        recyclingGrid->setDataSource(new DataSourceLiveVideoList(filtered));
+    if (index >= this->groupTitles.size()) return;
+    // Mostra anche il gruppo, con il callback della lista
+    const size_t row = datasource->selectGroup(upRecyclingGrid, index);
+    if (row < datasource->getItemCount()) upRecyclingGrid->selectRowAt(row, false);
 
     brls::Logger::debug("selectGroupIndex: {}", index);
 }
@@ -613,42 +874,78 @@ void HomeLive::search() {
 }
 
 void HomeLive::cancelSearch() {
+    // Un risultato ancora in arrivo non deve più sostituire la griglia
+    ++searchGeneration;
     isSearchActive = false;
-    this->recyclingGrid->setDataSource(new DataSourceLiveVideoList(this->channelsList));
+    // Senza lista dei gruppi la griglia torna all'unico gruppo
+    if (this->groupTitles.size() <= 1) {
+        this->showGroupList(0, false);
+        return;
+    }
     upRecyclingGrid->setVisibility(brls::Visibility::VISIBLE);
     this->selectGroupIndex(this->selectedGroupIndex);
 }
 
-void HomeLive::filter(const std::string& key) {
-    if (key.empty()) return;
-
-    isSearchActive = true;
+void HomeLive::setSearchCallback(UpdateSearchEvent* event) {
+    // Testo aggiornato a ogni tasto: ogni ricerca annulla quella precedente
+    event->subscribe([this](const std::string& text) { this->filter(text); });
+}
 
+void HomeLive::filter(const std::string& key) {
     brls::Threading::sync([this, key]() {
-        auto* datasource = dynamic_cast<DataSourceLiveVideoList*>(recyclingGrid->getDataSource());
-        if (datasource) {
-            tsvitch::LiveM3u8ListResult filtered;
-            std::string lowerKey = key;
-            std::transform(lowerKey.begin(), lowerKey.end(), lowerKey.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            for (const auto& item : this->channelsList) {
-                std::string lowerTitle = item.title;
-                std::transform(lowerTitle.begin(), lowerTitle.end(), lowerTitle.begin(),
-                               [](unsigned char c) { return std::tolower(c); });
-                std::string lowerGroupTitle = item.groupTitle;
-                std::transform(lowerGroupTitle.begin(), lowerGroupTitle.end(), lowerGroupTitle.begin(),
-                               [](unsigned char c) { return std::tolower(c); });
-                if (lowerTitle.find(lowerKey) != std::string::npos ||
-                    lowerGroupTitle.find(lowerKey) != std::string::npos)
-                    filtered.push_back(item);
-            }
-            if (filtered.empty()) {
-                recyclingGrid->setEmpty();
-            } else {
-                recyclingGrid->setDataSource(new DataSourceLiveVideoList(filtered));
-            }
-            upRecyclingGrid->setVisibility(brls::Visibility::GONE);
+        const uint64_t generation = ++searchGeneration;
+        if (key.empty()) {
+            if (isSearchActive) this->cancelSearch();
+            return;
         }
+        isSearchActive = true;
+        upRecyclingGrid->setVisibility(brls::Visibility::GONE);
+
+        // Indice non ancora pronto (o di un'altra lista): confronto con tutti i canali
+        std::shared_ptr<const tsvitch::ChannelSearchIndex> index;
+        if (this->searchIndex && this->searchIndex->store() == this->channelsList) index = this->searchIndex;
+
+        brls::Threading::async([this, isValidFlag = validityFlag, generation, key, store = this->channelsList, index]() {
+            auto cancelled = [&]() { return !isValidFlag->load() || generation != searchGeneration; };
+
+            auto start = std::chrono::high_resolution_clock::now();
+            auto found = index ? index->find(key, SEARCH_MAX_RESULTS, cancelled)
+                               : tsvitch::ChannelSearchIndex::scan(*store, key, cancelled);
+            if (cancelled()) return;
+            brls::Logger::debug("HomeLive: Search '{}' found {} channels in {}ms{}", key, found.size(),
+                                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count(),
+                                index ? "" : " (no index)");
+
+            auto results = std::make_shared<const std::vector<uint32_t>>(std::move(found));
+            brls::sync([this, isValidFlag, generation, store, results]() {
+                if (!isValidFlag->load() || generation != searchGeneration) return;
+                this->showSearchResults(generation, tsvitch::ChannelView(store, results));
+            });
+        });
+    });
+}
+
+void HomeLive::showSearchResults(uint64_t generation, tsvitch::ChannelView results) {
+    if (results.empty()) {
+        recyclingGrid->setEmpty();
+        return;
+    }
+
+    // Prima i risultati migliori, quanti ne servono per la prima schermata
+    const size_t total = results.size();
+    const size_t first = std::min(total, SEARCH_FIRST_BATCH);
+    auto* datasource   = new DataSourceLiveVideoList(
+        tsvitch::ChannelView(results.sharedStore(), results.sharedIndices(), 0, first));
+    recyclingGrid->setDataSource(datasource);
+    if (first == total) return;
+
+    // Poi tutti gli altri, senza ricreare la griglia né spostare la selezione
+    auto isValidFlag = validityFlag;
+    brls::sync([this, isValidFlag, generation, datasource, results = std::move(results)]() mutable {
+        if (!isValidFlag->load() || generation != searchGeneration) return;
+        if (recyclingGrid->getDataSource() != datasource) return;
+        datasource->setChannels(std::move(results));
+        recyclingGrid->notifyDataChanged();
     });
 }
 
@@ -662,21 +959,20 @@ void HomeLive::onShow() {
     }
     
     // Smart refresh: controlla se abbiamo già canali in memoria
-    if (!channelsList.empty()) {
-        brls::Logger::debug("HomeLive onShow: Already have {} channels in memory, checking if refresh needed", channelsList.size());
+    if (!channelsList->empty()) {
+        brls::Logger::debug("HomeLive onShow: Already have {} channels in memory, checking if refresh needed", channelsList->size());
         
         // Per decidere se ricaricare, controlla l'età della cache
         int iptvMode = ProgramConfig::instance().getSettingItem(SettingItem::IPTV_MODE, 0);
-        int maxCacheAge = (iptvMode == 1) ? 5 : 15; // Xtream: 5 min, M3U8: 15 min
         
-        brls::Threading::async([this, maxCacheAge, iptvMode, validityFlag = this->validityFlag] {
+        brls::Threading::async([this, iptvMode, validityFlag = this->validityFlag] {
             // Controlla se l'app è ancora valida prima di procedere
             if (!validityFlag || !validityFlag->load()) {
                 brls::Logger::debug("HomeLive onShow: async task canceled - app exiting");
                 return;
             }
             
-            bool needsRefresh = !ChannelManager::get()->isCacheValid(maxCacheAge);
+            bool needsRefresh = ChannelManager::get()->needsRevalidation();
             
             brls::sync([this, needsRefresh, iptvMode, validityFlag]() {
                 // Controlla di nuovo la validità prima di aggiornare l'UI
@@ -710,9 +1006,10 @@ void HomeLive::onShow() {
             return;
         }
         
-        auto cachedChannels = ChannelManager::get()->loadIfValid();
+        auto cachedChannels = loadGroupedCache();
+        bool needsRefresh   = !cachedChannels.empty() && ChannelManager::get()->needsRevalidation();
         
-        brls::sync([this, cachedChannels, validityFlag]() {
+        brls::sync([this, cachedChannels = std::move(cachedChannels), needsRefresh, validityFlag]() mutable {
             // Controlla di nuovo la validità prima di aggiornare l'UI
             if (!validityFlag || !validityFlag->load()) {
                 brls::Logger::debug("HomeLive onShow: fallback sync task canceled - app exiting");
@@ -720,8 +1017,9 @@ void HomeLive::onShow() {
             }
             
             if (!cachedChannels.empty()) {
-                brls::Logger::info("HomeLive onShow: Using valid cached channels ({} channels)", cachedChannels.size());
-                this->onLiveList(cachedChannels, false);
+                brls::Logger::info("HomeLive onShow: Using valid cached channels ({} channels)", cachedChannels.channelCount());
+                this->onLiveList(std::move(cachedChannels), false);
+                if (needsRefresh) this->requestLiveList();
             } else {
                 brls::Logger::info("HomeLive onShow: No valid cache, requesting fresh channels");
                 this->requestLiveList();
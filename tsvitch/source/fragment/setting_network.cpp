@@ -7,6 +7,7 @@
 
 #include "fragment/setting_network.hpp"
 #include "tsvitch.h"
+#include "tsvitch/util/channel_store.hpp"
 
 #include "tsvitch/result/setting.h"
 #include "utils/number_helper.hpp"
@@ -10,9 +10,17 @@
 
 using namespace brls::literals;
 
-void HomeLiveRequest::onLiveList(tsvitch::LiveM3u8ListResult result, bool firstLoad) {
+void HomeLiveRequest::onLiveList(tsvitch::ChannelGroups result, bool firstLoad) {
     // Base implementation - should be overridden in derived classes
-    brls::Logger::debug("HomeLiveRequest::onLiveList: Base implementation called with {} channels, firstLoad={}", result.size(), firstLoad);
+    brls::Logger::debug("HomeLiveRequest::onLiveList: Base implementation called with {} channels, firstLoad={}", result.channelCount(), firstLoad);
+}
+
+void HomeLiveRequest::onLiveListPreview(tsvitch::ChannelGroups result) {
+    brls::Logger::debug("HomeLiveRequest::onLiveListPreview: Base implementation called with {} channels", result.channelCount());
+}
+
+void HomeLiveRequest::onLiveListNotModified() {
+    brls::Logger::debug("HomeLiveRequest::onLiveListNotModified: Base implementation called");
 }
 
 void HomeLiveRequest::onError(const std::string& error) {
@@ -38,35 +46,47 @@ void HomeLiveRequest::requestLiveList() {
     auto isValidFlag = std::make_shared<std::atomic<bool>>(true);
     validityFlag = isValidFlag;
     
+    // Sorgente della richiesta: se nel frattempo è cambiata la risposta non va mostrata né salvata
+    auto source = ChannelManager::currentSource();
+    auto isStale = [this, source]() {
+        if (source == ChannelManager::currentSource()) return false;
+        brls::Logger::info("HomeLiveRequest: Source changed during the request, requesting again");
+        isRequestInProgress = false;
+        this->requestLiveList();
+        return true;
+    };
+
     // Use the new unified function that handles both M3U8 and Xtream modes
     brls::Logger::info("HomeLiveRequest: Requesting live channels...");
     CLIENT::get_live_channels(
-        [this, isValidFlag](const auto& result) {
+        [this, isValidFlag, isStale](tsvitch::ChannelGroups result) {
             // Check if this object is still valid before accessing it
             if (!isValidFlag->load()) {
                 brls::Logger::debug("HomeLiveRequest::requestLiveList: Object destroyed before callback");
                 isRequestInProgress = false; // Reset the flag even if object is destroyed
                 return;
             }
+            if (isStale()) return;
             
             try {
                 UNSET_REQUEST
-                tsvitch::LiveM3u8ListResult res = result; // copy once from client
-                brls::Logger::info("HomeLiveRequest: Successfully received {} channels", res.size());
-                this->onLiveList(std::move(res), true); // move into handler to avoid extra copies
+                brls::Logger::info("HomeLiveRequest: Successfully received {} channels in {} groups", result.channelCount(),
+                                   result.size());
+                this->onLiveList(std::move(result), true); // move into handler to avoid extra copies
                 isRequestInProgress = false; // Reset the flag on success
             } catch (...) {
                 brls::Logger::error("HomeLiveRequest::requestLiveList: Exception during callback");
                 isRequestInProgress = false; // Reset the flag on exception
             }
         },
-        [this, isValidFlag](const std::string &error, int code) {
+        [this, isValidFlag, isStale](const std::string &error, int code) {
             // Check if this object is still valid before accessing it
             if (!isValidFlag->load()) {
                 brls::Logger::debug("HomeLiveRequest::requestLiveList: Object destroyed before error callback");
                 isRequestInProgress = false; // Reset the flag even if object is destroyed
                 return;
             }
+            if (isStale()) return;
             
             try {
                 brls::Logger::error("HomeLiveRequest: Failed to fetch live channels: {}", error);
@@ -77,6 +97,23 @@ void HomeLiveRequest::requestLiveList() {
                 brls::Logger::error("HomeLiveRequest::requestLiveList: Exception during error callback");
                 isRequestInProgress = false; // Reset the flag on exception
             }
+        },
+        [this, isValidFlag, source](tsvitch::ChannelGroups result) {
+            if (!isValidFlag->load() || source != ChannelManager::currentSource()) return;
+            brls::Logger::info("HomeLiveRequest: Received preview with {} channels", result.channelCount());
+            this->onLiveListPreview(std::move(result));
+        },
+        [this, isValidFlag, isStale]() {
+            if (!isValidFlag->load()) {
+                isRequestInProgress = false;
+                return;
+            }
+            if (isStale()) return;
+            UNSET_REQUEST;
+            brls::Logger::info("HomeLiveRequest: Live channels not modified, reusing cache");
+            ChannelManager::get()->touchTimestamp();
+            isRequestInProgress = false;
+            this->onLiveListNotModified();
         }
     );
 }
\ No newline at end of file
@@ -19,6 +19,12 @@ void Intent::openLive(const std::vector<tsvitch::LiveM3u8>& channelList, size_t
     registerFullscreen(activity);
 }
 
+void Intent::openLive(tsvitch::ChannelView channels, size_t index, std::function<void()> onClose) {
+    auto activity = new LiveActivity(std::move(channels), index, std::move(onClose));
+    brls::Application::pushActivity(activity, brls::TransitionAnimation::NONE);
+    registerFullscreen(activity);
+}
+
 void Intent::openSettings(std::function<void()> onClose) {
     auto activity = new SettingsActivity(onClose);
     brls::Application::pushActivity(activity);
@@ -18,6 +18,8 @@
 #include "utils/number_helper.hpp"
 #include "utils/thread_helper.hpp"
 #include "utils/image_helper.hpp"
+#include "core/ImageCache.hpp"
+#include "core/ChannelManager.hpp"
 #include "utils/config_helper.hpp"
 #include "utils/crash_helper.hpp"
 #include "utils/vibration_helper.hpp"
@@ -28,6 +30,7 @@
 
 #include "config/m3u8_config.h"
 #include "api/tsvitch/util/http.hpp"
+#include "api/tsvitch/util/m3u_parser.hpp"
 
 #ifdef PS4
 #include <orbis/SystemService.h>
@@ -180,6 +183,35 @@ std::unordered_map<SettingItem, ProgramOption> ProgramConfig::SETTING_MAP = {
     {SettingItem::M3U8_URL_ITEM, {"m3u8_url", {}, {}, 0}},
     {SettingItem::PROXY_URL_ITEM, {"proxy_url", {}, {}, 0}},
     {SettingItem::M3U8_TIMEOUT, {"m3u8_timeout", {"60", "120", "300", "600"}, {60000, 120000, 300000, 600000}, 2}}, // Default: 5 minuti
+    // Oltre questa età (in minuti) la cache canali non viene più mostrata all'avvio. Default: 30 giorni
+    {SettingItem::CHANNEL_CACHE_MAX_AGE,
+     {"channel_cache_max_age", {"1", "7", "30", "90", "365"}, {1440, 10080, 43200, 129600, 525600}, 2}},
+    // Ordinamento dei canali nei gruppi, nell'ordine di tsvitch::ChannelOrder. Default: playlist
+    {SettingItem::CHANNEL_ORDER,
+     {"channel_order", {"Playlist", "Name", "Channel number", "Most watched", "Recently added"}, {0, 1, 2, 3, 4}, 0}},
+    {SettingItem::M3U8_PARSE_THREADS,
+     {"m3u8_parse_threads",
+#if defined(__SWITCH__) || defined(__PSV__)
+      {"1", "2"},
+      {1, 2},
+      0}},
+#else
+      {"1", "2", "4", "8"},
+      {1, 2, 4, 8},
+      2}},
+#endif
+    // Spazio su disco per le immagini scaricate (loghi dei canali), in MB. 0: nessuna cache
+    {SettingItem::IMAGE_DISK_CACHE,
+     {"image_disk_cache",
+#if defined(__SWITCH__) || defined(__PSV__)
+      {"0", "20", "50", "100"},
+      {0, 20, 50, 100},
+      2}},
+#else
+      {"0", "50", "100", "200", "500"},
+      {0, 50, 100, 200, 500},
+      2}},
+#endif
     
     // IPTV Mode Selection
     {SettingItem::IPTV_MODE, {"iptv_mode", {"M3U8 Playlist", "Xtream Codes"}, {0, 1}, 0}}, // Default: M3U8
@@ -356,6 +388,12 @@ void ProgramConfig::load() {
 
     ImageHelper::REQUEST_THREADS = getIntOption(SettingItem::IMAGE_REQUEST_THREADS);
 
+    ImageCache::MAX_SIZE_MB = getIntOption(SettingItem::IMAGE_DISK_CACHE);
+
+    tsvitch::M3uParser::PARSE_THREADS = getIntOption(SettingItem::M3U8_PARSE_THREADS);
+
+    ChannelManager::updateSettings();
+
     brls::Application::setFPSStatus(!getBoolOption(SettingItem::HIDE_FPS));
 
     VideoContext::FULLSCREEN = getBoolOption(SettingItem::FULLSCREEN);
@@ -785,6 +823,7 @@ void ProgramConfig::setM3U8Url(const std::string& url) {
     if (m3u8Url.empty()) {
         m3u8Url = M3U8_URL_VALUE;
     }
+    ChannelManager::updateSettings();
     GA("m3u8_url", {{"url", m3u8Url}});
 }
 
@@ -812,6 +851,7 @@ std::string ProgramConfig::getXtreamServerUrl() {
 
 void ProgramConfig::setXtreamServerUrl(const std::string& url) {
     setSettingItem(SettingItem::XTREAM_SERVER_URL, url);
+    ChannelManager::updateSettings();
     brls::Logger::info("setXtreamServerUrl: {}", url);
 }
 
@@ -821,6 +861,7 @@ std::string ProgramConfig::getXtreamUsername() {
 
 void ProgramConfig::setXtreamUsername(const std::string& username) {
     setSettingItem(SettingItem::XTREAM_USERNAME, username);
+    ChannelManager::updateSettings();
     brls::Logger::info("setXtreamUsername: {}", username);
 }
 
@@ -3,9 +3,13 @@
 #include <borealis/core/cache_helper.hpp>
 #include <borealis/core/thread.hpp>
 #include <stb_image.h>
+#include <algorithm>
+#include <cmath>
 
 #include "utils/image_helper.hpp"
 #include "api/tsvitch/util/http.hpp"
+#include "core/ImageCache.hpp"
+#include "api/tsvitch/util/thumbnail.hpp"
 
 #ifdef USE_WEBP
 #include <webp/decode.h>
@@ -21,6 +25,76 @@ public:
     ~ImageThreadPool() override { this->Stop(); }
 };
 
+// Intestazioni della risposta usate dalla cache su disco
+static ImageCacheHeaders cacheHeaders(const cpr::Response& r) {
+    ImageCacheHeaders headers;
+    auto value = [&r](const char* name) {
+        auto it = r.header.find(name);
+        return it != r.header.end() ? it->second : std::string{};
+    };
+    headers.cacheControl = value("Cache-Control");
+    headers.etag         = value("ETag");
+    headers.lastModified = value("Last-Modified");
+    return headers;
+}
+
+// GET sulla sessione persistente del thread: i loghi arrivano quasi sempre dagli stessi pochi
+// server, così si riusano connessione e sessione TLS invece di rifarle per ogni immagine
+static cpr::Response fetch(const std::string& url, const cpr::Header& headers,
+                           const cpr::ProgressCallback& progress) {
+    cpr::Session& session = tsvitch::HTTP::threadSession();
+    session.SetUrl(cpr::Url{url});
+    session.SetHeader(headers);
+    session.SetHttpVersion(cpr::HttpVersion{cpr::HttpVersionCode::VERSION_2_0_TLS});
+    session.SetTimeout(cpr::Timeout{tsvitch::HTTP::TIMEOUT});
+    session.SetProxies(tsvitch::HTTP::PROXIES);
+    session.SetVerifySsl(tsvitch::HTTP::VERIFY);
+    session.SetProgressCallback(progress);
+    return session.Get();
+}
+
+static bool isWebp(const std::string& url) { return url.size() > 5 && url.substr(url.size() - 5, 5) == ".webp"; }
+
+// Decodifica e riduce alla dimensione della vista sul thread di download: l'immagine intera
+// viene liberata subito, al thread principale arriva solo la miniatura da caricare
+static tsvitch::Thumbnail makeThumbnail(const std::string& url, const std::string& body, int boxWidth,
+                                        int boxHeight) {
+    tsvitch::Thumbnail thumbnail;
+    uint8_t* imageData = nullptr;
+    int imageW = 0, imageH = 0, n = 0;
+#ifdef USE_WEBP
+    if (isWebp(url)) {
+        imageData = WebPDecodeRGBA((const uint8_t*)body.data(), body.size(), &imageW, &imageH);
+        if (imageData) thumbnail = tsvitch::Thumbnail::fromRGBA(imageData, imageW, imageH, boxWidth, boxHeight, 1);
+        WebPFree(imageData);
+        return thumbnail;
+    }
+#endif
+    imageData = stbi_load_from_memory((unsigned char*)body.data(), (int)body.size(), &imageW, &imageH, &n, 4);
+    if (imageData) {
+        thumbnail = tsvitch::Thumbnail::fromRGBA(imageData, imageW, imageH, boxWidth, boxHeight, 1);
+        stbi_image_free(imageData);
+    }
+    return thumbnail;
+}
+
+// Miniatura scaduta, già mostrata dalla cache: chiede al server se l'immagine è cambiata, senza
+// bloccare nessuna vista. Con 304 resta la miniatura salvata, con 200 viene rifatta per il prossimo avvio
+static void revalidate(const std::string& url, const std::string& key, int boxWidth, int boxHeight,
+                       const ImageCache::Hit& hit) {
+    ImageThreadPool::instance().Submit(
+        [url, key, boxWidth, boxHeight, etag = hit.etag, lastModified = hit.lastModified]() {
+            cpr::Response r = fetch(url, tsvitch::HTTP::conditionalHeaders(etag, lastModified),
+                                    cpr::ProgressCallback([](...) -> bool { return true; }));
+            if (r.status_code == 304) {
+                ImageCache::get()->refresh(key, cacheHeaders(r));
+            } else if (r.status_code == 200) {
+                auto thumbnail = makeThumbnail(url, r.text, boxWidth, boxHeight);
+                if (!thumbnail.empty()) ImageCache::get()->store(key, thumbnail.encode(), cacheHeaders(r));
+            }
+        });
+}
+
 ImageHelper::ImageHelper(brls::Image* view) : imageView(view) {}
 
 ImageHelper::~ImageHelper() { brls::Logger::verbose("delete ImageHelper {}", (size_t)this); }
@@ -56,110 +130,216 @@ std::shared_ptr<ImageHelper> ImageHelper::with(brls::Image* view) {
 void ImageHelper::load(std::string url) {
     this->imageUrl = url;
 
+    // Dimensione in pixel della vista, arrotondata per eccesso: viste di poco diverse
+    // condividono la stessa miniatura
+    auto boxSide = [](float side) {
+        side *= brls::Application::windowScale;
+        if (!(side > 0)) return THUMBNAIL_SIZE;
+        return (int(std::ceil(side)) + THUMBNAIL_STEP - 1) / THUMBNAIL_STEP * THUMBNAIL_STEP;
+    };
+    this->boxWidth  = boxSide(this->imageView->getWidth());
+    this->boxHeight = boxSide(this->imageView->getHeight());
+    this->cacheKey  = fmt::format("{}#{}x{}", url, this->boxWidth, this->boxHeight);
+
     brls::Logger::verbose("load view: {} {}", (size_t)this->imageView, (size_t)this);
 
-    int tex = brls::TextureCache::instance().getCache(this->imageUrl);
+    int tex = brls::TextureCache::instance().getCache(this->cacheKey);
     if (tex > 0) {
-        brls::Logger::verbose("cache hit: {}", this->imageUrl);
+        brls::Logger::verbose("cache hit: {}", this->cacheKey);
         this->imageView->innerSetImage(tex);
         this->clean();
         return;
     }
 
     brls::Logger::verbose("request Image 1: {} {}", this->imageUrl, this->isCancel);
-    ImageThreadPool::instance().Submit([this]() {
-        brls::Logger::verbose("Submit view: {} {} {} {}", (size_t)this->imageView, (size_t)this, this->imageUrl,
-                              this->isCancel);
-        if (this->isCancel) {
-            this->clean();
-            return;
+    bool failedRecently = false;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+
+        // Scaricamento fallito da poco: resta il segnaposto, senza riprovare
+        auto failed = failedUrls.find(url);
+        if (failed != failedUrls.end()) {
+            failedRecently = std::chrono::steady_clock::now() < failed->second;
+            if (!failedRecently) failedUrls.erase(failed);
         }
-        this->requestImage();
-    });
+        if (!failedRecently) {
+            // Stesso logo già in arrivo per un'altra vista: si aspetta quello
+            auto& consumers = inflight[this->cacheKey];
+            consumers.push_back(this);
+            if (consumers.size() > 1) {
+                brls::Logger::verbose("request joined: {} ({} views)", this->cacheKey, consumers.size());
+                return;
+            }
+            this->priority = Priority{};
+            this->sequence = nextSequence++;
+            pending.push_back(this);
+        }
+    }
+    if (failedRecently) {
+        brls::Logger::verbose("request skipped, failed recently: {}", url);
+        this->clean();
+        return;
+    }
+    // Un compito per ogni richiesta: ciascuno prende quella più urgente in quel momento
+    ImageThreadPool::instance().Submit(&ImageHelper::runNext);
 }
 
-void ImageHelper::requestImage() {
-    brls::Logger::verbose("request Image 2: {} {}", this->imageUrl, this->isCancel);
-
-    cpr::Response r = cpr::Get(tsvitch::HTTP::VERIFY, tsvitch::HTTP::PROXIES, cpr::Url{this->imageUrl},
-                               cpr::ProgressCallback([this](...) -> bool { return !this->isCancel; }));
+void ImageHelper::runNext() {
+    ImageHelper* item;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        if (pending.empty()) return;
+        auto it = std::min_element(pending.begin(), pending.end(), [](ImageHelper* a, ImageHelper* b) {
+            if (before(a->priority, b->priority)) return true;
+            if (before(b->priority, a->priority)) return false;
+            return a->sequence < b->sequence;
+        });
+        item = *it;
+        pending.erase(it);
+    }
+    brls::Logger::verbose("Submit view: {} {} {} {}", (size_t)item->imageView, (size_t)item, item->imageUrl,
+                          item->isCancel);
+    if (item->isCancel) {
+        item->finishFailed();
+        return;
+    }
+    item->requestImage();
+}
 
-    if (r.status_code != 200 || r.downloaded_bytes == 0 || this->isCancel) {
-        brls::Logger::verbose("request undone: {} {} {} {}", r.status_code, r.downloaded_bytes, this->isCancel,
-                              r.url.str());
+bool ImageHelper::before(const Priority& a, const Priority& b) {
+    if (a.tier != b.tier) return a.tier < b.tier;
+    return a.distance < b.distance;
+}
 
-        this->clean();
-        return;
+void ImageHelper::prioritize(const std::function<std::optional<Priority>(brls::Image*)>& rank) {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    for (ImageHelper* item : pending) {
+        // Un logo condiviso vale quanto la più vicina delle viste che lo aspettano
+        std::optional<Priority> best;
+        for (ImageHelper* consumer : inflight[item->cacheKey]) {
+            auto p = rank(consumer->imageView);
+            if (p && (!best || before(*p, *best))) best = p;
+        }
+        if (best) item->priority = *best;
     }
+}
 
-    brls::Logger::verbose("load pic:{} size:{} bytes by{} to {} {}", r.url.str(), r.downloaded_bytes, (size_t)this,
-                          (size_t)this->imageView, this->imageView->describe());
+std::vector<ImageHelper*> ImageHelper::takeWaiting() {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    std::vector<ImageHelper*> waiting;
+    auto it = inflight.find(this->cacheKey);
+    if (it == inflight.end()) return waiting;
+    for (ImageHelper* item : it->second)
+        if (item != this) waiting.push_back(item);
+    inflight.erase(it);
+    return waiting;
+}
 
-    uint8_t* imageData = nullptr;
-    int imageW = 0, imageH = 0;
-    bool isWebp = false;
-    int n = 0;
+void ImageHelper::finishFailed() {
+    std::vector<ImageHelper*> waiting;
+    bool handedOver = false;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        auto it = inflight.find(this->cacheKey);
+        if (it != inflight.end()) {
+            auto& consumers = it->second;
+            consumers.erase(std::remove(consumers.begin(), consumers.end(), this), consumers.end());
+            if (this->isCancel && !consumers.empty()) {
+                // Solo questa vista non lo vuole più: il logo passa alla prossima che lo aspetta
+                consumers.front()->sequence = nextSequence++;
+                pending.push_back(consumers.front());
+                handedOver = true;
+            } else {
+                waiting = std::move(consumers);
+                inflight.erase(it);
+            }
+        }
+        if (!this->isCancel) {
+            const auto now = std::chrono::steady_clock::now();
+            if (failedUrls.size() >= FAILED_URLS_LIMIT) {
+                for (auto failed = failedUrls.begin(); failed != failedUrls.end();)
+                    failed = now >= failed->second ? failedUrls.erase(failed) : std::next(failed);
+            }
+            failedUrls[this->imageUrl] = now + std::chrono::seconds(FAILED_RETRY_SECONDS);
+        }
+    }
+    if (handedOver) ImageThreadPool::instance().Submit(&ImageHelper::runNext);
+    for (ImageHelper* item : waiting) item->clean();
+    this->clean();
+}
 
-#ifdef USE_WEBP
-    if (imageUrl.size() > 5 && imageUrl.substr(imageUrl.size() - 5, 5) == ".webp") {
-        imageData = WebPDecodeRGBA((const uint8_t*)r.text.c_str(), (size_t)r.downloaded_bytes, &imageW, &imageH);
-        isWebp    = true;
-        n = 4;
-    } else {
-#endif
-        imageData =
-            stbi_load_from_memory((unsigned char*)r.text.c_str(), (int)r.downloaded_bytes, &imageW, &imageH, &n, 4);
-#ifdef USE_WEBP
+void ImageHelper::requestImage() {
+    brls::Logger::verbose("request Image 2: {} {}", this->imageUrl, this->isCancel);
+
+    // Prima la miniatura su disco: dopo un riavvio i loghi già visti non passano dalla rete
+    // e non vanno nemmeno decodificati
+    tsvitch::Thumbnail thumbnail;
+    size_t bytes  = 0;
+    bool fromDisk = false;
+    if (auto hit = ImageCache::get()->find(this->cacheKey)) {
+        bytes = hit->data.size();
+        if (tsvitch::Thumbnail::decode(hit->data, thumbnail)) {
+            fromDisk = true;
+            if (hit->stale) revalidate(this->imageUrl, this->cacheKey, this->boxWidth, this->boxHeight, *hit);
+        } else {
+            // Copia su disco non più leggibile: si riscarica
+            ImageCache::get()->remove(this->cacheKey);
+        }
     }
-#endif
+    if (!fromDisk) {
+        // Cancellata mentre si leggeva il disco
+        if (this->isCancel) {
+            this->finishFailed();
+            return;
+        }
+        cpr::Response r = fetch(this->imageUrl, tsvitch::HTTP::HEADERS,
+                                cpr::ProgressCallback([this](...) -> bool { return !this->isCancel; }));
 
-    // --- AGGIUNTA: crea bordo trasparente ---
-    int border = 1; // 1 pixel trasparente su ogni lato
-    uint8_t* paddedData = nullptr;
-    int paddedW = imageW + border * 2;
-    int paddedH = imageH + border * 2;
-    if (imageData) {
-        paddedData = (uint8_t*)calloc(paddedW * paddedH * 4, 1); // RGBA, già tutto trasparente
-        for (int y = 0; y < imageH; ++y) {
-            memcpy(
-                paddedData + ((y + border) * paddedW + border) * 4,
-                imageData + (y * imageW) * 4,
-                imageW * 4
-            );
+        if (r.status_code != 200 || r.downloaded_bytes == 0 || this->isCancel) {
+            brls::Logger::verbose("request undone: {} {} {} {}", r.status_code, r.downloaded_bytes, this->isCancel,
+                                  r.url.str());
+
+            this->finishFailed();
+            return;
+        }
+        bytes     = r.text.size();
+        thumbnail = makeThumbnail(this->imageUrl, r.text, this->boxWidth, this->boxHeight);
+        if (thumbnail.empty()) {
+            brls::Logger::error("Failed to load image: {}", this->imageUrl);
+            this->finishFailed();
+            return;
         }
+        ImageCache::get()->store(this->cacheKey, thumbnail.encode(), cacheHeaders(r));
     }
-    // ----------------------------------------
 
-    brls::sync([this, r, paddedData, paddedW, paddedH, imageData, isWebp]() {
-        int tex = brls::TextureCache::instance().getCache(this->imageUrl);
+    brls::Logger::verbose("load pic:{} size:{} bytes{} -> {}x{} by{} to {} {}", this->imageUrl, bytes,
+                          fromDisk ? " (disk)" : "", thumbnail.width, thumbnail.height, (size_t)this,
+                          (size_t)this->imageView, this->imageView->describe());
+
+    brls::sync([this, thumbnail = std::move(thumbnail)]() {
+        int tex = brls::TextureCache::instance().getCache(this->cacheKey);
         if (tex > 0) {
-            brls::Logger::verbose("cache hit 2: {}", this->imageUrl);
+            brls::Logger::verbose("cache hit 2: {}", this->cacheKey);
             this->imageView->innerSetImage(tex);
         } else {
             NVGcontext* vg = brls::Application::getNVGContext();
-            if (paddedData) {
-                tex = nvgCreateImageRGBA(vg, paddedW, paddedH, 0, paddedData);
-            } else {
-                brls::Logger::error("Failed to load image: {}", this->imageUrl);
-            }
+            tex            = nvgCreateImageRGBA(vg, thumbnail.width, thumbnail.height, NVG_IMAGE_PREMULTIPLIED,
+                                                thumbnail.pixels.data());
 
             if (tex > 0) {
-                brls::TextureCache::instance().addCache(this->imageUrl, tex);
+                brls::TextureCache::instance().addCache(this->cacheKey, tex);
                 if (!this->isCancel) {
                     brls::Logger::verbose("load image: {}", this->imageUrl);
                     this->imageView->innerSetImage(tex);
                 }
             }
         }
-        if (paddedData)
-            free(paddedData);
-        if (imageData) {
-#ifdef USE_WEBP
-            if (isWebp)
-                WebPFree(imageData);
-            else
-#endif
-                stbi_image_free(imageData);
+        // Le altre viste con lo stesso logo prendono la stessa texture, come con un riscontro in cache
+        for (ImageHelper* item : this->takeWaiting()) {
+            if (tex > 0 && !item->isCancel) {
+                item->imageView->innerSetImage(brls::TextureCache::instance().getCache(this->cacheKey));
+            }
+            item->clean();
         }
         this->clean();
     });
@@ -179,16 +359,41 @@ void ImageHelper::clear(brls::Image* view) {
     brls::TextureCache::instance().removeCache(view->getTexture());
     view->clear();
 
-    std::lock_guard<std::mutex> lock(requestMutex);
-
-    if (requestMap.find(view) == requestMap.end()) return;
-
-    brls::Logger::verbose("clear view: {} {}", (size_t)view, (size_t)(*requestMap[view]).get());
-
-    if ((*requestMap[view])->imageView == view) {
-        (*requestMap[view])->cancel();
+    ImageHelper* dropped = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+
+        if (requestMap.find(view) == requestMap.end()) return;
+
+        brls::Logger::verbose("clear view: {} {}", (size_t)view, (size_t)(*requestMap[view]).get());
+
+        ImageHelper* item = (*requestMap[view]).get();
+        if (item->imageView == view) {
+            item->cancel();
+            // In attesa del logo di un'altra vista, o non ancora iniziata: si libera subito, senza
+            // aspettare il proprio turno. Chi aspettava lo stesso logo prende il suo posto in coda
+            auto consumers = inflight.find(item->cacheKey);
+            auto queued    = std::find(pending.begin(), pending.end(), item);
+            if (consumers != inflight.end()) {
+                auto& list = consumers->second;
+                auto self  = std::find(list.begin(), list.end(), item);
+                if (self != list.end() && (self != list.begin() || queued != pending.end())) {
+                    list.erase(self);
+                    if (queued != pending.end()) {
+                        pending.erase(queued);
+                        if (!list.empty()) {
+                            list.front()->sequence = nextSequence++;
+                            pending.push_back(list.front());
+                        }
+                    }
+                    if (list.empty()) inflight.erase(consumers);
+                    dropped = item;
+                }
+            }
+        }
+        requestMap.erase(view);
     }
-    requestMap.erase(view);
+    if (dropped) dropped->clean();
 }
 
 void ImageHelper::cancel() {
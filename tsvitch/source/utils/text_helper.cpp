@@ -0,0 +1,153 @@
+#include "utils/text_helper.hpp"
+
+namespace tsvitch {
+
+static constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+// Decodifica un code point UTF-8 a partire da p; restituisce la lunghezza della
+// sequenza, oppure 1 con U+FFFD se la sequenza non è valida
+static size_t decodeUtf8(const unsigned char* p, const unsigned char* end, char32_t& cp) {
+    const unsigned char c = p[0];
+    if (c < 0x80) {
+        cp = c;
+        return 1;
+    }
+
+    size_t length;
+    char32_t min;
+    if ((c & 0xE0) == 0xC0) {
+        length = 2;
+        min    = 0x80;
+        cp     = c & 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+        length = 3;
+        min    = 0x800;
+        cp     = c & 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+        length = 4;
+        min    = 0x10000;
+        cp     = c & 0x07;
+    } else {
+        cp = REPLACEMENT_CHARACTER;
+        return 1;
+    }
+
+    if (static_cast<size_t>(end - p) < length) {
+        cp = REPLACEMENT_CHARACTER;
+        return 1;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80) {
+            cp = REPLACEMENT_CHARACTER;
+            return 1;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+
+    // Rifiuta codifiche sovrabbondanti, surrogati e valori oltre U+10FFFF
+    if (cp < min || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) {
+        cp = REPLACEMENT_CHARACTER;
+        return 1;
+    }
+    return length;
+}
+
+static void appendUtf8(std::string& out, char32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Minuscolo per gli alfabeti più comuni nei nomi dei canali (latino, greco, cirillico)
+static char32_t foldCase(char32_t cp) {
+    if (cp < 0x80) return (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;
+    if (cp >= 0x100 && cp <= 0x137) return cp | 1;
+    if (cp >= 0x139 && cp <= 0x148) return (cp & 1) ? cp + 1 : cp;
+    if (cp >= 0x14A && cp <= 0x177) return cp | 1;
+    if (cp == 0x178) return 0xFF;
+    if (cp >= 0x179 && cp <= 0x17E) return (cp & 1) ? cp + 1 : cp;
+    if (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2) return cp + 0x20;
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;
+    return cp;
+}
+
+static inline bool isControl(char32_t cp) { return cp < 0x20 || (cp >= 0x7F && cp <= 0x9F); }
+
+static inline bool isSpace(char32_t cp) { return cp == ' ' || cp == '\t' || cp == '\n' || cp == '\r'; }
+
+// Accoda a cleaned e searchKey (se non nulli) il testo pulito e la sua versione minuscola
+static void sanitizeInto(std::string_view text, std::string* cleaned, std::string* searchKey) {
+    auto p         = reinterpret_cast<const unsigned char*>(text.data());
+    const auto end = p + text.size();
+
+    // Lo spazio viene scritto solo prima del carattere successivo: così si
+    // comprimono le sequenze e si eliminano quelli iniziali e finali
+    bool started      = false;
+    bool pendingSpace = false;
+    auto writeSpace   = [&]() {
+        if (cleaned) cleaned->push_back(' ');
+        if (searchKey) searchKey->push_back(' ');
+        pendingSpace = false;
+    };
+    while (p < end) {
+        // Percorso veloce per l'ASCII stampabile, la quasi totalità dei titoli
+        if (*p >= 0x21 && *p < 0x7F) {
+            if (pendingSpace) writeSpace();
+            if (cleaned) cleaned->push_back(static_cast<char>(*p));
+            if (searchKey) searchKey->push_back(static_cast<char>(foldCase(*p)));
+            started = true;
+            ++p;
+            continue;
+        }
+
+        char32_t cp;
+        p += decodeUtf8(p, end, cp);
+
+        if (isSpace(cp)) {
+            pendingSpace = started;
+            continue;
+        }
+        if (isControl(cp)) continue;
+
+        if (pendingSpace) writeSpace();
+        if (cleaned) appendUtf8(*cleaned, cp);
+        if (searchKey) appendUtf8(*searchKey, foldCase(cp));
+        started = true;
+    }
+}
+
+std::string sanitizeText(std::string_view text, std::string* searchKey) {
+    std::string cleaned;
+    if (searchKey) searchKey->clear();
+    if (text.empty()) return cleaned;
+
+    cleaned.reserve(text.size());
+    if (searchKey) searchKey->reserve(text.size());
+    sanitizeInto(text, &cleaned, searchKey);
+    return cleaned;
+}
+
+std::string foldText(std::string_view text) {
+    std::string key;
+    key.reserve(text.size());
+    sanitizeInto(text, nullptr, &key);
+    return key;
+}
+
+void appendFoldedText(std::string_view text, std::string& out) { sanitizeInto(text, nullptr, &out); }
+
+}  // namespace tsvitch
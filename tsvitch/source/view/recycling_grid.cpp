@@ -1,6 +1,7 @@
 #include <utility>
 #include "view/recycling_grid.hpp"
 #include "view/button_refresh.hpp"
+#include "utils/image_helper.hpp"
 
 RecyclingGridItem::RecyclingGridItem() {
     this->setFocusable(true);
@@ -511,6 +512,12 @@ void RecyclingGrid::itemsRecyclingLoop() {
         addCellAt(visibleMax + 1, true);
     }
 
+    if (visibleFrame.getMinY() != prioritizedOffset || contentBox->getChildren().size() != prioritizedCells) {
+        prioritizedOffset = visibleFrame.getMinY();
+        prioritizedCells  = contentBox->getChildren().size();
+        prioritizeImages(visibleFrame);
+    }
+
     if (visibleMax + 1 >= this->getItemCount()) {
         if (!requestNextPage && nextPageCallback) {
             if (dataSource && !dynamic_cast<DataSourceSkeleton*>(dataSource) && dataSource->getItemCount() > 0) {
@@ -522,6 +529,31 @@ void RecyclingGrid::itemsRecyclingLoop() {
     }
 }
 
+void RecyclingGrid::prioritizeImages(const brls::Rect& visibleFrame) {
+    // Le celle non vengono mai tolte durante lo scorrimento: quelle lontane restano in coda, per ultime
+    const float top      = visibleFrame.getMinY();
+    const float bottom   = visibleFrame.getMaxY();
+    const float center   = (top + bottom) / 2;
+    const float prefetch = preFetchLine * (estimatedRowHeight + estimatedRowSpace);
+    ImageHelper::prioritize([&](brls::Image* image) -> std::optional<ImageHelper::Priority> {
+        brls::View* cell = image;
+        while (cell && cell->getParent() != contentBox) cell = cell->getParent();
+        if (!cell) return std::nullopt;
+
+        const float cellTop    = cell->getDetachedPosition().y;
+        const float cellBottom = cellTop + cell->getHeight();
+        ImageHelper::Priority priority;
+        priority.distance = std::fabs((cellTop + cellBottom) / 2 - center);
+        if (cellBottom >= top && cellTop <= bottom)
+            priority.tier = ImageHelper::Tier::VISIBLE;
+        else if (cellBottom >= top - prefetch && cellTop <= bottom + prefetch)
+            priority.tier = ImageHelper::Tier::PREFETCH;
+        else
+            priority.tier = ImageHelper::Tier::FAR;
+        return priority;
+    });
+}
+
 RecyclingGridDataSource* RecyclingGrid::getDataSource() const { return this->dataSource; }
 
 void RecyclingGrid::showSkeleton(unsigned int num) { this->setDataSource(new DataSourceSkeleton(num)); }
@@ -0,0 +1,267 @@
+// Benchmark di M3uParser su playlist sintetiche: tempo di parseAll() e di feed() in
+// streaming al variare del numero di thread, con controllo che il risultato sia
+// identico a quello seriale.
+//
+// Compilato con -DBUILD_M3U_BENCH=ON, oppure da solo:
+//   g++ -std=c++17 -O2 -pthread -Itsvitch/include -Itsvitch/include/api -Ilibrary/nlohmann_json/include
+//       tsvitch/tools/m3u_parser_bench.cpp tsvitch/source/api/util/m3u_parser.cpp
+//       tsvitch/source/utils/text_helper.cpp -o m3u_parser_bench
+//
+// Uso: m3u_parser_bench [canali...] [-t thread...] [-r ripetizioni]
+//   default: 100000 500000 1000000 canali, 1 2 4 8 thread, 3 ripetizioni (vale la migliore)
+//
+// Misura anche parseExtInf su singole righe contro il vecchio ciclo byte per byte. Con
+// -DM3U_SIMD_NONE (target m3u_parser_bench_swar) lo scanner usa il fallback SWAR.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tsvitch/util/m3u_parser.hpp"
+#include "utils/text_helper.hpp"
+
+using tsvitch::LiveM3u8;
+using tsvitch::LiveM3u8ListResult;
+using tsvitch::M3uParser;
+
+// Attributi di catchup, su un canale ogni 7
+static const char* CATCHUP = " catchup=\"default\" catchup-days=\"3\" tvg-rec=\"3\" catchup-source=\"?utc={utc}\"";
+
+// Playlist con gruppi, loghi, attributi catchup e qualche titolo non ASCII, come quelle reali.
+// Un canale su 11 ha gli attributi attaccati senza spazi (tvg-logo="x"group-title="y"), come
+// capita in alcune playlist generate
+static std::string makePlaylist(size_t channels) {
+    static const char* groups[] = {"News", "Sport | Calcio", "Film: Azione", "Kids", "Música", "Documentari"};
+    std::string text = "#EXTM3U x-tvg-url=\"http://epg.example.com/guide.xml.gz\"\n";
+    text.reserve(channels * 240);
+    char line[512];
+    for (size_t i = 0; i < channels; ++i) {
+        const char* group = groups[i % (sizeof(groups) / sizeof(groups[0]))];
+        const char* sep   = i % 11 == 0 ? "" : " ";
+        int n = std::snprintf(line, sizeof(line),
+                              "#EXTINF:-1 tvg-id=\"ch%zu.example\" tvg-chno=\"%zu\" tvg-name=\"Canale %zu\"%s"
+                              "tvg-logo=\"http://logo.example.com/%zu.png\"%sgroup-title=\"%s\"%s,Canale %zu %s\n"
+                              "http://stream.example.com:8080/live/user/pass/%zu.ts\n",
+                              i, i + 1, i, sep, i % 5000, sep, group,
+                              i % 7 == 0 ? CATCHUP : "", i,
+                              i % 3 == 0 ? "HD" : (i % 3 == 1 ? "Città" : "FHD ★"), i);
+        text.append(line, static_cast<size_t>(n));
+    }
+    return text;
+}
+
+// Confronto con i valori attesi: il confronto col risultato seriale da solo non vede un errore
+// del parser stesso, come un attributo perso
+static bool expectedResult(const LiveM3u8ListResult& result, size_t channels) {
+    if (result.size() != channels) return false;
+    for (size_t i = 0; i < channels; ++i) {
+        const auto& entry = result[i];
+        if (entry.id != "ch" + std::to_string(i) + ".example" || entry.chno != std::to_string(i + 1) ||
+            entry.tvgName != "Canale " + std::to_string(i) ||
+            entry.logo != "http://logo.example.com/" + std::to_string(i % 5000) + ".png" || entry.groupTitle.empty() ||
+            entry.catchup != (i % 7 == 0 ? "default" : "") || entry.tvgRec != (i % 7 == 0 ? "3" : "") ||
+            entry.catchupSource != (i % 7 == 0 ? "?utc={utc}" : "")) {
+            std::printf("channel %zu parsed wrong: id=\"%s\" logo=\"%s\" group=\"%s\"\n", i, entry.id.c_str(),
+                        entry.logo.c_str(), entry.groupTitle.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool sameResult(const LiveM3u8ListResult& a, const LiveM3u8ListResult& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        // Tutti i campi di LiveM3u8
+        if (a[i].id != b[i].id || a[i].chno != b[i].chno || a[i].title != b[i].title || a[i].logo != b[i].logo ||
+            a[i].groupTitle != b[i].groupTitle || a[i].url != b[i].url || a[i].tvgName != b[i].tvgName ||
+            a[i].tvgRec != b[i].tvgRec || a[i].catchup != b[i].catchup || a[i].catchupSource != b[i].catchupSource)
+            return false;
+    }
+    return true;
+}
+
+// Stesse chiavi e stesso switch di M3uParser: il confronto misura solo la scansione della riga
+static void assignOld(std::string_view key, std::string_view value, LiveM3u8& entry) {
+    if (value.empty()) return;
+
+    switch (key.size()) {
+        case 6:
+            if (key == "tvg-id") entry.id.assign(value.data(), value.size());
+            break;
+        case 7:
+            if (key == "tvg-rec")
+                entry.tvgRec.assign(value.data(), value.size());
+            else if (key == "catchup")
+                entry.catchup.assign(value.data(), value.size());
+            break;
+        case 8:
+            if (key == "tvg-chno")
+                entry.chno.assign(value.data(), value.size());
+            else if (key == "tvg-logo")
+                entry.logo.assign(value.data(), value.size());
+            else if (key == "tvg-name")
+                entry.tvgName = tsvitch::sanitizeText(value);
+            break;
+        case 11:
+            if (key == "group-title") {
+                std::string group(value);
+                std::replace(group.begin(), group.end(), ';', ' ');
+                entry.groupTitle = tsvitch::sanitizeText(group);
+            }
+            break;
+        case 14:
+            if (key == "catchup-source") entry.catchupSource.assign(value.data(), value.size());
+            break;
+        default:
+            break;
+    }
+}
+
+static inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+// Il ciclo di parseExtInf prima di StructuralScanner: un byte alla volta, memchr per le virgolette
+static void parseExtInfOld(std::string_view extinf, LiveM3u8& entry) {
+    const char* data = extinf.data();
+    const size_t len = extinf.size();
+
+    size_t i = 0;
+    while (i < len) {
+        const char c = data[i];
+        if (c == ',') {
+            entry.title = tsvitch::sanitizeText(extinf.substr(i + 1));
+            return;
+        }
+        if (c == '"') {
+            const void* close = std::memchr(data + i + 1, '"', len - i - 1);
+            i                 = close ? static_cast<const char*>(close) - data + 1 : len;
+            continue;
+        }
+        if (c == '=' && i + 1 < len && data[i + 1] == '"') {
+            size_t keyStart = i;
+            while (keyStart > 0 && !isBlank(data[keyStart - 1])) --keyStart;
+
+            const size_t valueStart = i + 2;
+            const void* close       = std::memchr(data + valueStart, '"', len - valueStart);
+            const size_t valueEnd   = close ? static_cast<const char*>(close) - data : len;
+
+            assignOld(extinf.substr(keyStart, i - keyStart), extinf.substr(valueStart, valueEnd - valueStart), entry);
+            i = valueEnd + 1;
+            continue;
+        }
+        ++i;
+    }
+}
+
+template <typename Fn>
+static double bestOf(int repeat, Fn&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        best               = std::min(best, std::chrono::duration<double, std::milli>(elapsed).count());
+    }
+    return best;
+}
+
+// ns per chiamata di parseExtInf, vecchio ciclo contro StructuralScanner
+static bool benchExtInf(int repeat) {
+    static const char* lines[][2] = {
+        {"tvg-id/logo/group",
+         "-1 tvg-id=\"rai1.it\" tvg-logo=\"http://logo.example.com/rai1.png\" group-title=\"Generalisti\",Rai 1 HD"},
+        {"8 attributes",
+         "-1 tvg-id=\"rai1.it\" tvg-chno=\"1\" tvg-name=\"Rai 1\" tvg-logo=\"http://logo.example.com/rai1.png\" "
+         "group-title=\"Generalisti\" tvg-rec=\"7\" catchup=\"default\" "
+         "catchup-source=\"http://tv.example.com/rai1/{utc}-{duration}.ts\",Rai 1 HD"},
+    };
+    constexpr int CALLS = 1000000;
+
+#if defined(M3U_SIMD_NONE)
+    std::printf("\nparseExtInf (scanner: SWAR fallback)\n");
+#else
+    std::printf("\nparseExtInf (scanner: SIMD where available)\n");
+#endif
+    std::printf("%-20s %12s %12s %8s %s\n", "line", "old loop", "scanner", "speedup", "check");
+    for (const auto& line : lines) {
+        const std::string_view extinf = line[1];
+        LiveM3u8 oldEntry, newEntry;
+        size_t sink = 0;
+        const double oldMs = bestOf(repeat, [&] {
+            for (int i = 0; i < CALLS; ++i) {
+                oldEntry = LiveM3u8{};
+                parseExtInfOld(extinf, oldEntry);
+                sink += oldEntry.title.size();
+            }
+        });
+        const double newMs = bestOf(repeat, [&] {
+            for (int i = 0; i < CALLS; ++i) {
+                newEntry = LiveM3u8{};
+                M3uParser::parseExtInf(extinf, newEntry);
+                sink += newEntry.title.size();
+            }
+        });
+        LiveM3u8ListResult a{oldEntry}, b{newEntry};
+        const bool ok = sink > 0 && sameResult(a, b);
+        std::printf("%-20s %10.0fns %10.0fns %7.2fx %s\n", line[0], oldMs * 1e6 / CALLS, newMs * 1e6 / CALLS,
+                    oldMs / newMs, ok ? "ok" : "MISMATCH");
+        if (!ok) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes, threads;
+    int repeat = 3;
+    std::vector<size_t>* target = &sizes;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0) {
+            target = &threads;
+        } else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            target->push_back(std::strtoull(argv[i], nullptr, 10));
+        }
+    }
+    if (sizes.empty()) sizes = {100000, 500000, 1000000};
+    if (threads.empty()) threads = {1, 2, 4, 8};
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    std::printf("%10s %8s %7s %10s %10s %8s %10s %8s %s\n", "channels", "MB", "threads", "parseAll", "MB/s",
+                "speedup", "feed", "speedup", "check");
+
+    for (size_t size : sizes) {
+        const std::string playlist = makePlaylist(size);
+        const double mb            = playlist.size() / (1024.0 * 1024.0);
+        const LiveM3u8ListResult serial = M3uParser::parseAll(playlist, 1);
+        if (!expectedResult(serial, size)) return 1;
+
+        double baseAll = 0, baseFeed = 0;
+        for (size_t workers : threads) {
+            LiveM3u8ListResult all, streamed;
+            const double allMs = bestOf(repeat, [&] { all = M3uParser::parseAll(playlist, workers); });
+            // Blocchi da 64 KB, come arrivano dalla rete
+            const double feedMs = bestOf(repeat, [&] {
+                streamed.clear();
+                M3uParser parser(streamed, workers);
+                for (size_t pos = 0; pos < playlist.size(); pos += 64 * 1024)
+                    parser.feed(std::string_view(playlist).substr(pos, 64 * 1024));
+                parser.finish();
+            });
+            if (workers == threads.front()) {
+                baseAll  = allMs;
+                baseFeed = feedMs;
+            }
+            const bool ok = sameResult(serial, all) && sameResult(serial, streamed);
+            std::printf("%10zu %8.1f %7zu %8.0fms %10.1f %7.2fx %8.0fms %7.2fx %s\n", size, mb, workers, allMs,
+                        mb / (allMs / 1000), baseAll / allMs, feedMs, baseFeed / feedMs, ok ? "ok" : "MISMATCH");
+            if (!ok) return 1;
+        }
+    }
+    return benchExtInf(repeat) ? 0 : 1;
+}
@@ -170,6 +170,7 @@ target("TsVitch")
         add_defines("BOREALIS_USE_METAL")
     end
     add_defines("USE_WEBP")
+    add_defines("USE_ZLIB")
     if get_config("window") == 'sdl' then
         add_defines("__SDL2__=1")
         add_packages("sdl2")